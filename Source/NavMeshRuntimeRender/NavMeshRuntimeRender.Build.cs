@@ -36,13 +36,17 @@ public class NavMeshRuntimeRender : ModuleRules
 			{
 				"CoreUObject",
 				"Engine",
+				"RenderCore",
+				"RHI",
 				"Slate",
 				"SlateCore",
 				"NavigationSystem",
+				"Navmesh",
                 "GeometryFramework",
                 "GeometryCore",
                 "GeometryScriptingCore",
 				"AssetRegistry",
+				"Json",
                 "StaticMeshDescription",
                 "ModelingComponents",
                 "ModelingComponentsEditorOnly",
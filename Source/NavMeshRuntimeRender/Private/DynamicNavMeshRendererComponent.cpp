@@ -4,6 +4,9 @@
 #include "DynamicNavMeshRendererComponent.h"
 
 FBoxSphereBounds UDynamicNavMeshRendererComponent::CalcBounds(const FTransform& LocalToWorld) const {
+	if (!bUseNavMeshBounds) {
+		return Super::CalcBounds(LocalToWorld);
+	}
 	FBox LocalBoundingBox = (FBox)LocalBounds;
 	FBoxSphereBounds retVal(LocalBoundingBox.TransformBy(LocalToWorld));
 	retVal.BoxExtent = BoundsExtents;
@@ -0,0 +1,285 @@
+// Cutter H // 2024
+
+
+#include "NavMeshCompactRenderComponent.h"
+#include "NavMeshRenderStats.h"
+#include "NavMeshRenderBuilder.h"
+
+#include "DynamicMesh/DynamicMesh3.h"
+#include "DynamicMesh/DynamicMeshAttributeSet.h"
+#include "Engine/CollisionProfile.h"
+#include "LocalVertexFactory.h"
+#include "MaterialDomain.h"
+#include "Materials/Material.h"
+#include "Misc/EngineVersionComparison.h"
+#include "PrimitiveSceneProxy.h"
+#include "RawIndexBuffer.h"
+#include "SceneManagement.h"
+#include "StaticMeshResources.h"
+
+namespace {
+	constexpr double QuantizeSteps = 65535.0;
+
+	FVector GetQuantizeStep(const FBox& bounds) {
+		const FVector size = bounds.GetSize();
+		return FVector(
+			size.X > 0 ? size.X / QuantizeSteps : 1.0,
+			size.Y > 0 ? size.Y / QuantizeSteps : 1.0,
+			size.Z > 0 ? size.Z / QuantizeSteps : 1.0);
+	}
+
+	uint16 Quantize(double value, double step) {
+		return (uint16)FMath::Clamp(FMath::RoundToInt(value / step), 0, (int32)QuantizeSteps);
+	}
+}
+
+/*
+ * Draws a compact render through the local vertex factory with a constant tangent basis and no color stream.
+ * UVs stay full precision, half floats can't address the texels of a large atlas.
+ * The mesh never changes for the life of the proxy, so it is drawn as a static mesh.
+ */
+class FNavMeshCompactRenderSceneProxy final : public FPrimitiveSceneProxy
+{
+public:
+	FNavMeshCompactRenderSceneProxy(const UNavMeshCompactRenderComponent* component)
+		: FPrimitiveSceneProxy(component)
+		, VertexFactory(GetScene().GetFeatureLevel(), "FNavMeshCompactRenderSceneProxy")
+		, MaterialRelevance(component->GetMaterialRelevance(GetScene().GetFeatureLevel())) {
+		Material = component->GetMaterial(0);
+		if (!Material) {
+			Material = UMaterial::GetDefaultMaterial(MD_Surface);
+		}
+		const int32 numVerts = component->GetNumVertices();
+		VertexBuffers.PositionVertexBuffer.Init(numVerts);
+		VertexBuffers.StaticMeshVertexBuffer.SetUseFullPrecisionUVs(true);
+		VertexBuffers.StaticMeshVertexBuffer.Init(numVerts, 1);
+		for (int32 i = 0; i < numVerts; i++) {
+			VertexBuffers.PositionVertexBuffer.VertexPosition(i) = component->GetVertexPosition(i);
+			VertexBuffers.StaticMeshVertexBuffer.SetVertexTangents(i, FVector3f::ForwardVector, FVector3f::RightVector, FVector3f::UpVector);
+			VertexBuffers.StaticMeshVertexBuffer.SetVertexUV(i, 0, component->GetVertexUV(i));
+		}
+		TArray<uint32> indices;
+		indices.SetNumUninitialized(component->GetNumIndices());
+		for (int32 i = 0; i < indices.Num(); i++) {
+			indices[i] = component->GetIndex(i);
+		}
+		// Picks 16-bit indices whenever every index fits.
+		IndexBuffer.SetIndices(indices, EIndexBufferStride::AutoDetect);
+
+		BeginInitResource(&VertexBuffers.PositionVertexBuffer);
+		BeginInitResource(&VertexBuffers.StaticMeshVertexBuffer);
+		BeginInitResource(&IndexBuffer);
+		FLocalVertexFactory* vertexFactory = &VertexFactory;
+		FStaticMeshVertexBuffers* vertexBuffers = &VertexBuffers;
+		ENQUEUE_RENDER_COMMAND(InitNavMeshCompactRenderVertexFactory)([vertexFactory, vertexBuffers](FRHICommandListImmediate& RHICmdList) {
+			FLocalVertexFactory::FDataType data;
+			vertexBuffers->PositionVertexBuffer.BindPositionVertexBuffer(vertexFactory, data);
+			vertexBuffers->StaticMeshVertexBuffer.BindTangentVertexBuffer(vertexFactory, data);
+			vertexBuffers->StaticMeshVertexBuffer.BindPackedTexCoordVertexBuffer(vertexFactory, data);
+			// The color buffer is never filled, so this binds the engine's null color buffer.
+			vertexBuffers->ColorVertexBuffer.BindColorVertexBuffer(vertexFactory, data);
+#if UE_VERSION_OLDER_THAN(5, 3, 0)
+			vertexFactory->SetData(data);
+#else
+			vertexFactory->SetData(RHICmdList, data);
+#endif
+		});
+		BeginInitResource(&VertexFactory);
+	}
+
+	virtual ~FNavMeshCompactRenderSceneProxy() {
+		VertexBuffers.PositionVertexBuffer.ReleaseResource();
+		VertexBuffers.StaticMeshVertexBuffer.ReleaseResource();
+		IndexBuffer.ReleaseResource();
+		VertexFactory.ReleaseResource();
+	}
+
+	virtual SIZE_T GetTypeHash() const override {
+		static size_t uniquePointer;
+		return reinterpret_cast<size_t>(&uniquePointer);
+	}
+
+	virtual void DrawStaticElements(FStaticPrimitiveDrawInterface* PDI) override {
+		if (IndexBuffer.GetNumIndices() <= 0) {
+			return;
+		}
+		FMeshBatch meshBatch;
+		meshBatch.VertexFactory = &VertexFactory;
+		meshBatch.MaterialRenderProxy = Material->GetRenderProxy();
+		meshBatch.ReverseCulling = IsLocalToWorldDeterminantNegative();
+		meshBatch.Type = PT_TriangleList;
+		meshBatch.DepthPriorityGroup = SDPG_World;
+		meshBatch.LODIndex = 0;
+		meshBatch.CastShadow = true;
+		FMeshBatchElement& batchElement = meshBatch.Elements[0];
+		batchElement.IndexBuffer = &IndexBuffer;
+		batchElement.FirstIndex = 0;
+		batchElement.NumPrimitives = IndexBuffer.GetNumIndices() / 3;
+		batchElement.MinVertexIndex = 0;
+		batchElement.MaxVertexIndex = VertexBuffers.PositionVertexBuffer.GetNumVertices() - 1;
+		PDI->DrawMesh(meshBatch, FLT_MAX);
+	}
+
+	virtual FPrimitiveViewRelevance GetViewRelevance(const FSceneView* View) const override {
+		FPrimitiveViewRelevance retVal;
+		retVal.bDrawRelevance = IsShown(View);
+		retVal.bShadowRelevance = IsShadowCast(View);
+		retVal.bStaticRelevance = true;
+		retVal.bRenderInMainPass = ShouldRenderInMainPass();
+		retVal.bUsesLightingChannels = GetLightingChannelMask() != GetDefaultLightingChannelMask();
+		retVal.bRenderCustomDepth = ShouldRenderCustomDepth();
+		MaterialRelevance.SetPrimitiveViewRelevance(retVal);
+		return retVal;
+	}
+
+	virtual bool CanBeOccluded() const override {
+		return !MaterialRelevance.bDisableDepthTest;
+	}
+
+	virtual uint32 GetMemoryFootprint() const override {
+		return sizeof(*this) + GetAllocatedSize();
+	}
+
+private:
+	UMaterialInterface* Material = nullptr;
+	FStaticMeshVertexBuffers VertexBuffers;
+	FRawStaticIndexBuffer IndexBuffer;
+	FLocalVertexFactory VertexFactory;
+	FMaterialRelevance MaterialRelevance;
+};
+
+UNavMeshCompactRenderComponent::UNavMeshCompactRenderComponent() {
+	PrimaryComponentTick.bCanEverTick = false;
+	SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
+}
+
+void UNavMeshCompactRenderComponent::SetMesh(const UE::Geometry::FDynamicMesh3& mesh, const FBox& quantizeGrid) {
+	NAVMESHRENDER_SCOPE_CYCLE_COUNTER(STAT_NavMeshRender_CompactMesh);
+	const UE::Geometry::FDynamicMeshUVOverlay* uvOverlay = mesh.HasAttributes() ? mesh.Attributes()->PrimaryUV() : nullptr;
+	// Mesh vertex IDs can have holes, so the used vertices are renumbered in triangle order.
+	TArray<int32> meshToCompact;
+	meshToCompact.Init(INDEX_NONE, mesh.MaxVertexID());
+	TArray<FVector> positions;
+	TArray<FVector2f> uvs;
+	TArray<uint32> indices;
+	indices.Reserve(mesh.TriangleCount() * 3);
+	for (int32 tid : mesh.TriangleIndicesItr()) {
+		const UE::Geometry::FIndex3i tri = mesh.GetTriangle(tid);
+		const UE::Geometry::FIndex3i uvTri = uvOverlay && uvOverlay->IsSetTriangle(tid) ? uvOverlay->GetTriangle(tid) : UE::Geometry::FIndex3i::Invalid();
+		for (int32 k = 0; k < 3; k++) {
+			int32& compactIndex = meshToCompact[tri[k]];
+			if (compactIndex == INDEX_NONE) {
+				compactIndex = positions.Add(mesh.GetVertex(tri[k]));
+				uvs.Add(uvTri[k] >= 0 ? uvOverlay->GetElement(uvTri[k]) : FVector2f::Zero());
+			}
+			indices.Add(compactIndex);
+		}
+	}
+
+	QuantizeGrid = quantizeGrid;
+	const FVector step = GetQuantizeStep(QuantizeGrid);
+	Positions.SetNumUninitialized(positions.Num() * 3);
+	UVs.SetNumUninitialized(uvs.Num() * 2);
+	for (int32 i = 0; i < positions.Num(); i++) {
+		const FVector relativePosition = positions[i] - QuantizeGrid.Min;
+		Positions[i * 3] = Quantize(relativePosition.X, step.X);
+		Positions[i * 3 + 1] = Quantize(relativePosition.Y, step.Y);
+		Positions[i * 3 + 2] = Quantize(relativePosition.Z, step.Z);
+		UVs[i * 2] = Quantize(uvs[i].X, 1.0 / QuantizeSteps);
+		UVs[i * 2 + 1] = Quantize(uvs[i].Y, 1.0 / QuantizeSteps);
+	}
+	LocalBounds = FBox(ForceInit);
+	for (int32 i = 0; i < positions.Num(); i++) {
+		LocalBounds += FVector(GetVertexPosition(i));
+	}
+	Indices16.Reset();
+	Indices32.Reset();
+	if (positions.Num() <= MAX_uint16 + 1) {
+		Indices16.SetNumUninitialized(indices.Num());
+		for (int32 i = 0; i < indices.Num(); i++) {
+			Indices16[i] = (uint16)indices[i];
+		}
+	}
+	else {
+		Indices32 = MoveTemp(indices);
+	}
+	UpdateBounds();
+	MarkRenderStateDirty();
+}
+
+void UNavMeshCompactRenderComponent::CopyToMesh(UE::Geometry::FDynamicMesh3& outMesh) const {
+	NavMeshRender::InitRenderMesh(outMesh);
+	UE::Geometry::FDynamicMeshUVOverlay* uvOverlay = outMesh.Attributes()->PrimaryUV();
+	const int32 numVerts = GetNumVertices();
+	for (int32 i = 0; i < numVerts; i++) {
+		outMesh.AppendVertex(FVector(GetVertexPosition(i)));
+		uvOverlay->AppendElement(GetVertexUV(i));
+	}
+	const int32 numIndices = GetNumIndices();
+	for (int32 i = 0; i + 2 < numIndices; i += 3) {
+		UE::Geometry::FIndex3i tri(GetIndex(i), GetIndex(i + 1), GetIndex(i + 2));
+		int32 tid = outMesh.AppendTriangle(tri);
+		if (tid == UE::Geometry::FDynamicMesh3::NonManifoldID) {
+			// Same as the builder, overlapping layers get their own verts.
+			for (int32 k = 0; k < 3; k++) {
+				const int32 vertexIndex = tri[k];
+				tri[k] = outMesh.AppendVertex(FVector(GetVertexPosition(vertexIndex)));
+				uvOverlay->AppendElement(GetVertexUV(vertexIndex));
+			}
+			tid = outMesh.AppendTriangle(tri);
+		}
+		if (tid >= 0) {
+			uvOverlay->SetTriangle(tid, tri);
+		}
+	}
+}
+
+void UNavMeshCompactRenderComponent::ClearMesh() {
+	QuantizeGrid = FBox(ForceInit);
+	LocalBounds = FBox(ForceInit);
+	Positions.Empty();
+	UVs.Empty();
+	Indices16.Empty();
+	Indices32.Empty();
+	UpdateBounds();
+	MarkRenderStateDirty();
+}
+
+int32 UNavMeshCompactRenderComponent::GetNumTriangles() const {
+	return GetNumIndices() / 3;
+}
+
+SIZE_T UNavMeshCompactRenderComponent::GetDataSize() const {
+	return Positions.GetAllocatedSize() + UVs.GetAllocatedSize() + Indices16.GetAllocatedSize() + Indices32.GetAllocatedSize();
+}
+
+FVector3f UNavMeshCompactRenderComponent::GetVertexPosition(int32 vertexIndex) const {
+	const FBox& grid = GetQuantizeGrid();
+	const FVector step = GetQuantizeStep(grid);
+	return FVector3f(grid.Min + FVector(
+		Positions[vertexIndex * 3] * step.X,
+		Positions[vertexIndex * 3 + 1] * step.Y,
+		Positions[vertexIndex * 3 + 2] * step.Z));
+}
+
+FVector2f UNavMeshCompactRenderComponent::GetVertexUV(int32 vertexIndex) const {
+	return FVector2f(UVs[vertexIndex * 2] / QuantizeSteps, UVs[vertexIndex * 2 + 1] / QuantizeSteps);
+}
+
+FPrimitiveSceneProxy* UNavMeshCompactRenderComponent::CreateSceneProxy() {
+	if (GetNumIndices() <= 0 || GetNumVertices() <= 0) {
+		return nullptr;
+	}
+	return new FNavMeshCompactRenderSceneProxy(this);
+}
+
+FBoxSphereBounds UNavMeshCompactRenderComponent::CalcBounds(const FTransform& LocalToWorld) const {
+	if (!LocalBounds.IsValid) {
+		return FBoxSphereBounds(LocalToWorld.GetLocation(), FVector::ZeroVector, 0.f);
+	}
+	return FBoxSphereBounds(LocalBounds.TransformBy(LocalToWorld));
+}
+
+int32 UNavMeshCompactRenderComponent::GetNumMaterials() const {
+	return 1;
+}
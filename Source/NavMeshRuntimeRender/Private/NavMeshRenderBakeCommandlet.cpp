@@ -0,0 +1,261 @@
+// Cutter H // 2024
+
+
+#include "NavMeshRenderBakeCommandlet.h"
+#include "NavMeshRenderer.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "Engine/StaticMesh.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "ImageUtils.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+#include "UObject/SavePackage.h"
+
+UNavMeshRenderBakeCommandlet::UNavMeshRenderBakeCommandlet() {
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UNavMeshRenderBakeCommandlet::Main(const FString& params) {
+	FParse::Value(*params, TEXT("SaveLocation="), SaveLocationOverride);
+	if (!FParse::Value(*params, TEXT("HashDir="), HashDir)) {
+		HashDir = FPaths::ProjectSavedDir() / TEXT("NavMeshRenderBake");
+	}
+	bForce = FParse::Param(*params, TEXT("Force"));
+	FParse::Value(*params, TEXT("RasterSize="), RasterSize);
+	if (!FParse::Value(*params, TEXT("RasterDir="), RasterDir)) {
+		RasterDir = FPaths::ProjectSavedDir() / TEXT("NavMeshRenderBake");
+	}
+
+	int32 processCount = 0;
+	FParse::Value(*params, TEXT("Processes="), processCount);
+	// A shard is already a child, or was launched by an outside scheduler, and must not fork again.
+	int32 shardCount = 1;
+	const bool bIsShard = FParse::Value(*params, TEXT("ShardCount="), shardCount);
+	if (processCount > 1 && !bIsShard) {
+		return RunChildProcesses(params, processCount) > 0 ? 1 : 0;
+	}
+
+	TArray<FString> maps;
+	FString mapsString;
+	if (FParse::Value(*params, TEXT("Maps="), mapsString, false)) {
+		mapsString.ParseIntoArray(maps, TEXT("+"));
+	}
+	FString mapDir;
+	if (FParse::Value(*params, TEXT("MapDir="), mapDir)) {
+		GatherMaps(mapDir, maps);
+	}
+	if (maps.IsEmpty()) {
+		UE_LOG(LogNavigation, Error, TEXT("NavMeshRenderBake found no maps. Pass -Maps=/Game/Map1+/Game/Map2 or -MapDir=/Game/Maps."));
+		return 1;
+	}
+	// Sorted so every shard sees the same order.
+	maps.Sort();
+
+	int32 shardIndex = 0;
+	FParse::Value(*params, TEXT("ShardIndex="), shardIndex);
+	shardCount = FMath::Max(shardCount, 1);
+
+	int32 bakedCount = 0;
+	int32 skippedCount = 0;
+	int32 failedCount = 0;
+	for (int32 m = 0; m < maps.Num(); m++) {
+		if (m % shardCount != shardIndex) {
+			continue;
+		}
+		switch (BakeMap(maps[m])) {
+		case EBakeResult::Baked:
+			bakedCount++;
+			break;
+		case EBakeResult::Skipped:
+			skippedCount++;
+			break;
+		case EBakeResult::Failed:
+			failedCount++;
+			break;
+		}
+	}
+	UE_LOG(LogNavigation, Display, TEXT("NavMeshRenderBake finished. Baked: %d Skipped: %d Failed: %d"), bakedCount, skippedCount, failedCount);
+	return failedCount > 0 ? 1 : 0;
+}
+
+UNavMeshRenderBakeCommandlet::EBakeResult UNavMeshRenderBakeCommandlet::BakeMap(const FString& mapPackageName) {
+	UE_LOG(LogNavigation, Display, TEXT("NavMeshRenderBake loading %s"), *mapPackageName);
+	UPackage* mapPackage = LoadPackage(nullptr, *mapPackageName, LOAD_None);
+	UWorld* world = IsValid(mapPackage) ? UWorld::FindWorldInPackage(mapPackage) : nullptr;
+	if (!IsValid(world)) {
+		UE_LOG(LogNavigation, Error, TEXT("NavMeshRenderBake could not load map %s"), *mapPackageName);
+		return EBakeResult::Failed;
+	}
+	world->WorldType = EWorldType::Editor;
+	world->AddToRoot();
+	if (!world->bIsWorldInitialized) {
+		// Navigation is all that's needed, the saved nav tiles are registered without rebuilding them.
+		UWorld::InitializationValues initValues;
+		initValues.RequiresHitProxies(false)
+			.ShouldSimulatePhysics(false)
+			.EnableTraceCollision(false)
+			.CreatePhysicsScene(false)
+			.CreateNavigation(true)
+			.CreateAISystem(false)
+			.AllowAudioPlayback(false);
+		world->InitWorld(initValues);
+	}
+	world->UpdateWorldComponents(true, false);
+
+	EBakeResult retVal = EBakeResult::Failed;
+	ANavMeshRenderer* renderer = FindOrSpawnRenderer(world);
+	const uint32 hash = IsValid(renderer) ? renderer->GetNavMeshRenderHash() : 0;
+	if (hash == 0) {
+		UE_LOG(LogNavigation, Error, TEXT("NavMeshRenderBake found no Navigation Mesh in %s"), *mapPackageName);
+	}
+	else {
+		const FString saveLocation = SaveLocationOverride.IsEmpty() ? renderer->SaveLocation : SaveLocationOverride;
+		FString packageName = FString("/Game/") + saveLocation + FString("/") + GetFlatMapName(mapPackageName) + FString("_NavMeshRender");
+		FPaths::RemoveDuplicateSlashes(packageName);
+		uint32 bakedHash = 0;
+		const bool bRasterMissing = RasterSize > 0 && !IFileManager::Get().FileExists(*GetRasterFilePath(mapPackageName));
+		if (!bForce && !bRasterMissing && ReadBakedHash(mapPackageName, bakedHash) && bakedHash == hash && FPackageName::DoesPackageExist(packageName)) {
+			UE_LOG(LogNavigation, Display, TEXT("NavMeshRenderBake skipped %s, its navmesh is unchanged."), *mapPackageName);
+			retVal = EBakeResult::Skipped;
+		}
+		else {
+			// Reuses the render saved with the level when it is still current.
+			renderer->UpdateMeshIfStale();
+			UStaticMesh* staticMesh = renderer->SaveMeshAsset(packageName);
+			if (IsValid(staticMesh)) {
+				UPackage* meshPackage = staticMesh->GetPackage();
+				const FString fileName = FPackageName::LongPackageNameToFilename(meshPackage->GetName(), FPackageName::GetAssetPackageExtension());
+				FSavePackageArgs saveArgs;
+				saveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+				saveArgs.SaveFlags = SAVE_NoError;
+				if (!UPackage::SavePackage(meshPackage, staticMesh, *fileName, saveArgs)) {
+					UE_LOG(LogNavigation, Error, TEXT("NavMeshRenderBake could not write %s"), *fileName);
+				}
+				// The hash is only written once every output is, so a failed raster is retried on the next bake.
+				else if (RasterSize <= 0 || WriteRaster(*renderer, mapPackageName)) {
+					WriteBakedHash(mapPackageName, hash);
+					UE_LOG(LogNavigation, Display, TEXT("NavMeshRenderBake saved %s"), *fileName);
+					retVal = EBakeResult::Baked;
+				}
+			}
+		}
+	}
+
+	world->CleanupWorld();
+	world->RemoveFromRoot();
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	return retVal;
+}
+
+int32 UNavMeshRenderBakeCommandlet::RunChildProcesses(const FString& params, int32 processCount) const {
+	const FString projectPath = FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath());
+	// Children ignore -Processes since they get -ShardCount, it is only dropped to keep their command lines short.
+	const FString childParams = params.Replace(*FString::Printf(TEXT("-Processes=%d"), processCount), TEXT(""));
+	TArray<FProcHandle> processes;
+	for (int32 p = 0; p < processCount; p++) {
+		const FString commandLine = FString::Printf(TEXT("\"%s\" -run=NavMeshRenderBake %s -ShardIndex=%d -ShardCount=%d -nullrhi -unattended -nopause"),
+			*projectPath, *childParams, p, processCount);
+		FProcHandle process = FPlatformProcess::CreateProc(FPlatformProcess::ExecutablePath(), *commandLine, false, true, true, nullptr, 0, nullptr, nullptr);
+		if (!process.IsValid()) {
+			UE_LOG(LogNavigation, Error, TEXT("NavMeshRenderBake could not launch shard %d"), p);
+		}
+		processes.Add(process);
+	}
+	int32 retVal = 0;
+	for (int32 p = 0; p < processes.Num(); p++) {
+		if (!processes[p].IsValid()) {
+			retVal++;
+			continue;
+		}
+		FPlatformProcess::WaitForProc(processes[p]);
+		int32 returnCode = 1;
+		FPlatformProcess::GetProcReturnCode(processes[p], &returnCode);
+		FPlatformProcess::CloseProc(processes[p]);
+		if (returnCode != 0) {
+			UE_LOG(LogNavigation, Error, TEXT("NavMeshRenderBake shard %d failed with code %d"), p, returnCode);
+			retVal++;
+		}
+	}
+	UE_LOG(LogNavigation, Display, TEXT("NavMeshRenderBake finished %d shards, %d failed."), processCount, retVal);
+	return retVal;
+}
+
+ANavMeshRenderer* UNavMeshRenderBakeCommandlet::FindOrSpawnRenderer(UWorld* world) const {
+	for (TActorIterator<ANavMeshRenderer> it(world); it; ++it) {
+		return *it;
+	}
+	FActorSpawnParameters spawnParams;
+	spawnParams.ObjectFlags |= RF_Transient;
+	return world->SpawnActor<ANavMeshRenderer>(spawnParams);
+}
+
+FString UNavMeshRenderBakeCommandlet::GetFlatMapName(const FString& mapPackageName) const {
+	FString retVal = mapPackageName;
+	retVal.RemoveFromStart(TEXT("/"));
+	retVal.ReplaceCharInline(TEXT('/'), TEXT('_'));
+	return retVal;
+}
+
+FString UNavMeshRenderBakeCommandlet::GetHashFilePath(const FString& mapPackageName) const {
+	return HashDir / GetFlatMapName(mapPackageName) + TEXT(".hash");
+}
+
+bool UNavMeshRenderBakeCommandlet::ReadBakedHash(const FString& mapPackageName, uint32& outHash) const {
+	FString hashString;
+	if (!FFileHelper::LoadFileToString(hashString, *GetHashFilePath(mapPackageName))) {
+		return false;
+	}
+	hashString.TrimStartAndEndInline();
+	outHash = (uint32)FCString::Strtoui64(*hashString, nullptr, 10);
+	return true;
+}
+
+void UNavMeshRenderBakeCommandlet::WriteBakedHash(const FString& mapPackageName, uint32 hash) const {
+	FFileHelper::SaveStringToFile(FString::Printf(TEXT("%u"), hash), *GetHashFilePath(mapPackageName));
+}
+
+void UNavMeshRenderBakeCommandlet::GatherMaps(const FString& mapDir, TArray<FString>& outMaps) const {
+	IAssetRegistry& assetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	assetRegistry.SearchAllAssets(true);
+	FARFilter filter;
+	filter.PackagePaths.Add(FName(*mapDir));
+	filter.bRecursivePaths = true;
+	filter.ClassPaths.Add(UWorld::StaticClass()->GetClassPathName());
+	TArray<FAssetData> mapAssets;
+	assetRegistry.GetAssets(filter, mapAssets);
+	for (const FAssetData& mapAsset : mapAssets) {
+		outMaps.AddUnique(mapAsset.PackageName.ToString());
+	}
+}
+
+FString UNavMeshRenderBakeCommandlet::GetRasterFilePath(const FString& mapPackageName) const {
+	return RasterDir / GetFlatMapName(mapPackageName) + TEXT("_NavMeshRaster.png");
+}
+
+bool UNavMeshRenderBakeCommandlet::WriteRaster(ANavMeshRenderer& renderer, const FString& mapPackageName) const {
+	const FString fileName = GetRasterFilePath(mapPackageName);
+	if (!renderer.UpdateRaster(RasterSize)) {
+		UE_LOG(LogNavigation, Error, TEXT("NavMeshRenderBake could not rasterize %s"), *mapPackageName);
+		return false;
+	}
+	const FIntPoint size = renderer.GetRasterSize();
+	const TConstArrayView<FColor> texels = renderer.GetRasterTexels();
+	TArray64<uint8> png;
+	FImageUtils::PNGCompressImageArray(size.X, size.Y, TArrayView64<const FColor>(texels.GetData(), texels.Num()), png);
+	if (png.IsEmpty() || !FFileHelper::SaveArrayToFile(png, *fileName)) {
+		UE_LOG(LogNavigation, Error, TEXT("NavMeshRenderBake could not write %s"), *fileName);
+		return false;
+	}
+	UE_LOG(LogNavigation, Display, TEXT("NavMeshRenderBake saved %s"), *fileName);
+	return true;
+}
@@ -0,0 +1,244 @@
+// Cutter H // 2024
+
+
+#include "NavMeshRenderBenchmarkCommandlet.h"
+#include "NavMeshRenderBuilder.h"
+#include "NavMeshRenderSynthetic.h"
+#include "DynamicNavMeshRendererComponent.h"
+#include "NavMeshCompactRenderComponent.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "NavMesh/RecastNavMesh.h"
+#include "Engine/World.h"
+#include "RenderingThread.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/PlatformTime.h"
+
+namespace {
+	/*
+	* Min, mean and max of a phase across iterations, in milliseconds.
+	*/
+	struct FPhaseTimes
+	{
+		double MinMs = TNumericLimits<double>::Max();
+		double MaxMs = 0.0;
+		double TotalMs = 0.0;
+		int32 Count = 0;
+
+		void Add(double seconds) {
+			const double ms = seconds * 1000.0;
+			MinMs = FMath::Min(MinMs, ms);
+			MaxMs = FMath::Max(MaxMs, ms);
+			TotalMs += ms;
+			Count++;
+		}
+		TSharedRef<FJsonObject> ToJson() const {
+			TSharedRef<FJsonObject> retVal = MakeShared<FJsonObject>();
+			retVal->SetNumberField(TEXT("minMs"), Count > 0 ? MinMs : 0.0);
+			retVal->SetNumberField(TEXT("meanMs"), Count > 0 ? TotalMs / Count : 0.0);
+			retVal->SetNumberField(TEXT("maxMs"), MaxMs);
+			return retVal;
+		}
+	};
+}
+
+UNavMeshRenderBenchmarkCommandlet::UNavMeshRenderBenchmarkCommandlet() {
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UNavMeshRenderBenchmarkCommandlet::Main(const FString& params) {
+	FNavMeshRenderSyntheticSettings settings;
+	FParse::Value(*params, TEXT("Tiles="), settings.TilesPerSide);
+	FParse::Value(*params, TEXT("PolysPerTile="), settings.PolysPerTile);
+	FParse::Value(*params, TEXT("Floors="), settings.Floors);
+	settings.TilesPerSide = FMath::Max(settings.TilesPerSide, 1);
+	settings.PolysPerTile = FMath::Max(settings.PolysPerTile, 1);
+	settings.Floors = FMath::Max(settings.Floors, 1);
+	FString triangulationName;
+	if (FParse::Value(*params, TEXT("Triangulation="), triangulationName)) {
+		const int64 triangulation = StaticEnum<ENavMeshRenderTriangulation>()->GetValueByNameString(triangulationName);
+		if (triangulation == INDEX_NONE) {
+			UE_LOG(LogNavigation, Error, TEXT("NavMeshRenderBenchmark unknown triangulation %s"), *triangulationName);
+			return 1;
+		}
+		settings.Triangulation = (ENavMeshRenderTriangulation)triangulation;
+	}
+	int32 iterations = 5;
+	int32 uvQueries = 1000000;
+	FParse::Value(*params, TEXT("Iterations="), iterations);
+	FParse::Value(*params, TEXT("UVQueries="), uvQueries);
+	iterations = FMath::Max(iterations, 1);
+	uvQueries = FMath::Max(uvQueries, 1);
+	FString outputPath;
+	if (!FParse::Value(*params, TEXT("Output="), outputPath)) {
+		outputPath = FPaths::ProjectSavedDir() / TEXT("NavMeshRenderBenchmark") / FDateTime::Now().ToString() + TEXT(".json");
+	}
+
+	// A world of its own holds a nav mesh to gather from and the components the mesh is handed to, initialized the way the bake initializes a map.
+	UWorld::InitializationValues initValues;
+	initValues.RequiresHitProxies(false)
+		.ShouldSimulatePhysics(false)
+		.EnableTraceCollision(false)
+		.CreatePhysicsScene(false)
+		.CreateNavigation(false)
+		.CreateAISystem(false)
+		.AllowAudioPlayback(false);
+	UWorld* world = UWorld::CreateWorld(EWorldType::Editor, false, TEXT("NavMeshRenderBenchmark"), nullptr, true, ERHIFeatureLevel::Num, &initValues);
+	world->UpdateWorldComponents(true, false);
+	// The synthetic tiles go through Detour, so gathering reads the same Recast data it reads from a generated nav mesh.
+	TArray<FNavMeshRenderTileSnapshot> syntheticTiles;
+	NavMeshRender::MakeSyntheticTiles(settings, syntheticTiles);
+	const FNavMeshRenderLayout layout = NavMeshRender::MakeSyntheticLayout(settings, syntheticTiles);
+	ARecastNavMesh* navMesh = world->SpawnActor<ARecastNavMesh>();
+	if (!IsValid(navMesh) || !NavMeshRender::MakeSyntheticNavMesh(settings, syntheticTiles, *navMesh)) {
+		UE_LOG(LogNavigation, Error, TEXT("NavMeshRenderBenchmark could not build the synthetic nav mesh"));
+		world->RemoveFromRoot();
+		world->DestroyWorld(false);
+		return 1;
+	}
+	UDynamicNavMeshRendererComponent* renderComponent = NewObject<UDynamicNavMeshRendererComponent>(navMesh);
+	UNavMeshCompactRenderComponent* compactComponent = NewObject<UNavMeshCompactRenderComponent>(navMesh);
+	renderComponent->RegisterComponentWithWorld(world);
+	compactComponent->RegisterComponentWithWorld(world);
+
+	// The phases run the same code UpdateMesh does.
+	FPhaseTimes gatherTimes;
+	FPhaseTimes triangulateTimes;
+	FPhaseTimes attributeCopyTimes;
+	FPhaseTimes spatialIndexTimes;
+	FPhaseTimes componentUpdateTimes;
+	int32 polyCount = 0;
+	int32 vertexCount = 0;
+	int32 triangleCount = 0;
+	SIZE_T meshBytes = 0;
+	SIZE_T compactBytes = 0;
+	SIZE_T indexBytes = 0;
+	for (int32 i = 0; i < iterations; i++) {
+		TArray<FNavMeshRenderTileSnapshot> tiles;
+		double start = FPlatformTime::Seconds();
+		NavMeshRender::GatherTiles(*navMesh, layout.Triangulation, tiles);
+		gatherTimes.Add(FPlatformTime::Seconds() - start);
+
+		TArray<FNavMeshRenderTileBuffers> tileBuffers;
+		start = FPlatformTime::Seconds();
+		NavMeshRender::BuildTiles(layout, tiles, tileBuffers);
+		triangulateTimes.Add(FPlatformTime::Seconds() - start);
+
+		UE::Geometry::FDynamicMesh3 mesh;
+		FNavMeshRenderMeshState state;
+		start = FPlatformTime::Seconds();
+		NavMeshRender::InitRenderMesh(mesh);
+		FNavMeshRenderMeshWriter meshWriter(mesh, state, layout);
+		for (int32 t = 0; t < tiles.Num(); t++) {
+			meshWriter.AppendTile(tiles[t], tileBuffers[t]);
+		}
+		attributeCopyTimes.Add(FPlatformTime::Seconds() - start);
+
+		TArray<FNavMeshRenderTileIndex> tileIndices;
+		tileIndices.SetNum(tiles.Num());
+		start = FPlatformTime::Seconds();
+		for (int32 t = 0; t < tiles.Num(); t++) {
+			NavMeshRender::BuildTileIndex(layout, tiles[t], tileBuffers[t], tileIndices[t]);
+		}
+		spatialIndexTimes.Add(FPlatformTime::Seconds() - start);
+
+		polyCount = 0;
+		for (const FNavMeshRenderTileSnapshot& tile : tiles) {
+			polyCount += tile.Polys.Num();
+		}
+		vertexCount = mesh.VertexCount();
+		triangleCount = mesh.TriangleCount();
+		meshBytes = mesh.GetByteCount();
+		indexBytes = 0;
+		for (const FNavMeshRenderTileIndex& tileIndex : tileIndices) {
+			indexBytes += tileIndex.GetAllocatedSize();
+		}
+
+		// Render state is only recreated at the end of a frame, so it is sent right away and the render thread is waited on, covering the new proxies.
+		UE::Geometry::FDynamicMesh3 componentMesh = mesh;
+		start = FPlatformTime::Seconds();
+		renderComponent->SetMesh(MoveTemp(componentMesh));
+		compactComponent->SetMesh(mesh, layout.GetQuantizeGrid());
+		world->SendAllEndOfFrameUpdates();
+		FlushRenderingCommands();
+		componentUpdateTimes.Add(FPlatformTime::Seconds() - start);
+		compactBytes = compactComponent->GetDataSize();
+	}
+	renderComponent->UnregisterComponent();
+	compactComponent->UnregisterComponent();
+	world->RemoveFromRoot();
+	world->DestroyWorld(false);
+
+	// UV throughput, one call at a time and batched.
+	FRandomStream random(1234);
+	TArray<FVector> uvLocations;
+	uvLocations.SetNumUninitialized(uvQueries);
+	for (FVector& location : uvLocations) {
+		location = layout.NavMeshCorner + FVector(random.FRand(), random.FRand(), random.FRand()) * layout.NavMeshSize;
+	}
+	TArray<FVector2f> uvs;
+	uvs.SetNumUninitialized(uvQueries);
+	double start = FPlatformTime::Seconds();
+	for (int32 q = 0; q < uvQueries; q++) {
+		uvs[q] = layout.UVCoord(uvLocations[q], uvLocations[q].Z);
+	}
+	const double uvCoordSeconds = FPlatformTime::Seconds() - start;
+	start = FPlatformTime::Seconds();
+	layout.UVCoords(uvLocations, TConstArrayView<float>(), uvs);
+	const double uvCoordsSeconds = FPlatformTime::Seconds() - start;
+
+	TSharedRef<FJsonObject> settingsJson = MakeShared<FJsonObject>();
+	settingsJson->SetNumberField(TEXT("tilesPerSide"), settings.TilesPerSide);
+	settingsJson->SetNumberField(TEXT("polysPerTile"), settings.PolysPerTile);
+	settingsJson->SetNumberField(TEXT("floors"), settings.Floors);
+	settingsJson->SetStringField(TEXT("triangulation"), StaticEnum<ENavMeshRenderTriangulation>()->GetNameStringByValue((int64)settings.Triangulation));
+	settingsJson->SetNumberField(TEXT("iterations"), iterations);
+	settingsJson->SetNumberField(TEXT("uvQueries"), uvQueries);
+
+	TSharedRef<FJsonObject> countsJson = MakeShared<FJsonObject>();
+	countsJson->SetNumberField(TEXT("tiles"), settings.TilesPerSide * settings.TilesPerSide * settings.Floors);
+	countsJson->SetNumberField(TEXT("polys"), polyCount);
+	countsJson->SetNumberField(TEXT("vertices"), vertexCount);
+	countsJson->SetNumberField(TEXT("triangles"), triangleCount);
+
+	TSharedRef<FJsonObject> memoryJson = MakeShared<FJsonObject>();
+	memoryJson->SetNumberField(TEXT("meshBytes"), meshBytes);
+	memoryJson->SetNumberField(TEXT("compactBytes"), compactBytes);
+	memoryJson->SetNumberField(TEXT("spatialIndexBytes"), indexBytes);
+
+	TSharedRef<FJsonObject> phasesJson = MakeShared<FJsonObject>();
+	phasesJson->SetObjectField(TEXT("gather"), gatherTimes.ToJson());
+	phasesJson->SetObjectField(TEXT("triangulate"), triangulateTimes.ToJson());
+	phasesJson->SetObjectField(TEXT("attributeCopy"), attributeCopyTimes.ToJson());
+	phasesJson->SetObjectField(TEXT("spatialIndex"), spatialIndexTimes.ToJson());
+	phasesJson->SetObjectField(TEXT("componentUpdate"), componentUpdateTimes.ToJson());
+
+	TSharedRef<FJsonObject> uvJson = MakeShared<FJsonObject>();
+	uvJson->SetNumberField(TEXT("uvCoordNsPerQuery"), uvCoordSeconds * 1e9 / uvQueries);
+	uvJson->SetNumberField(TEXT("uvCoordsNsPerQuery"), uvCoordsSeconds * 1e9 / uvQueries);
+
+	TSharedRef<FJsonObject> root = MakeShared<FJsonObject>();
+	root->SetStringField(TEXT("date"), FDateTime::UtcNow().ToIso8601());
+	root->SetObjectField(TEXT("settings"), settingsJson);
+	root->SetObjectField(TEXT("counts"), countsJson);
+	root->SetObjectField(TEXT("memory"), memoryJson);
+	root->SetObjectField(TEXT("phases"), phasesJson);
+	root->SetObjectField(TEXT("uv"), uvJson);
+	FString json;
+	TSharedRef<TJsonWriter<>> writer = TJsonWriterFactory<>::Create(&json);
+	FJsonSerializer::Serialize(root, writer);
+
+	UE_LOG(LogNavigation, Display, TEXT("NavMeshRenderBenchmark results: %s"), *json);
+	if (!FFileHelper::SaveStringToFile(json, *outputPath)) {
+		UE_LOG(LogNavigation, Error, TEXT("NavMeshRenderBenchmark could not write %s"), *outputPath);
+		return 1;
+	}
+	UE_LOG(LogNavigation, Display, TEXT("NavMeshRenderBenchmark wrote %s"), *outputPath);
+	return 0;
+}
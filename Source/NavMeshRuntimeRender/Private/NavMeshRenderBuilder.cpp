@@ -0,0 +1,910 @@
+// Cutter H // 2024
+
+
+#include "NavMeshRenderBuilder.h"
+#include "NavMeshRenderStats.h"
+
+#include "Async/ParallelFor.h"
+#include "Components/LineBatchComponent.h"
+#include "DynamicMesh/DynamicMesh3.h"
+#include "NavMesh/RecastNavMesh.h"
+#if WITH_RECAST
+#include "Detour/DetourNavMesh.h"
+#include "NavMesh/RecastHelpers.h"
+#endif
+
+namespace {
+	// Positions are snapped to a 0.1 unit grid before being compared.
+	constexpr double VertexWeldPrecision = 10.0;
+	// Distance from the tile bounds within which a vertex is considered to be on the tile border.
+	constexpr double TileBorderTolerance = 1.0;
+	// Lifts outline lines off the filled render so they don't z-fight with it.
+	constexpr float OutlineZBias = 2.f;
+}
+
+FNavMeshRenderVertexKey::FNavMeshRenderVertexKey(const FVector& location, int32 floor)
+	: Position(
+		FMath::RoundToInt(location.X * VertexWeldPrecision),
+		FMath::RoundToInt(location.Y * VertexWeldPrecision),
+		FMath::RoundToInt(location.Z * VertexWeldPrecision))
+	, Floor(floor) {
+}
+
+void FNavMeshRenderTileBuffers::Reset() {
+	Positions.Reset();
+	UVs.Reset();
+	Floors.Reset();
+	BorderVertices.Reset();
+	Triangles.Reset();
+	TrianglePolys.Reset();
+	TrianglePolyIndices.Reset();
+	TriangleAreas.Reset();
+}
+
+FNavMeshRenderTileBuilder::FNavMeshRenderTileBuilder(const FNavMeshRenderLayout& layout, const FBox& tileBounds, FNavMeshRenderTileBuffers& outBuffers)
+	: Layout(layout)
+	, TileBounds(tileBounds)
+	, Buffers(outBuffers) {
+}
+
+void FNavMeshRenderMeshState::Reset() {
+	BorderVertices.Reset();
+	BorderVertexKeys.Reset();
+	VertexUVElements.Reset();
+	TileTriangles.Reset();
+	TileSignatures.Reset();
+	TileDataHashes.Reset();
+}
+
+void FNavMeshRenderTileBuilder::AddPoly(const FNavMeshRenderPolySnapshot& poly) {
+	if (poly.Verts.Num() < 3) {
+		return;
+	}
+	const int32 firstTriangle = Buffers.Triangles.Num();
+	switch (Layout.Triangulation) {
+	case ENavMeshRenderTriangulation::DetailMesh:
+		if (poly.DetailTriangles.Num() >= 3) {
+			AddDetailTriangles(poly.DetailTriangles, poly.Center.Z);
+			break;
+		}
+		// Polys without detail triangles fall back to the plain fan.
+		AddConvexFan(poly.Verts, poly.Center.Z);
+		break;
+	case ENavMeshRenderTriangulation::ConvexFan:
+		AddConvexFan(poly.Verts, poly.Center.Z);
+		break;
+	default:
+		AddCenterFan(poly.Center, poly.Verts);
+		break;
+	}
+	const uint32 packedArea = NavMeshRender::PackArea(poly.Area, poly.Flags);
+	for (int32 t = firstTriangle; t < Buffers.Triangles.Num(); t++) {
+		Buffers.TrianglePolys.Add(poly.Ref);
+		Buffers.TrianglePolyIndices.Add(poly.PolyIndex);
+		Buffers.TriangleAreas.Add(packedArea);
+	}
+}
+
+void FNavMeshRenderTileBuilder::AddCenterFan(const FVector& center, const TArray<FVector>& verts) {
+	const float uvHeight = center.Z;
+	const int32 centerIndex = FindOrAddVertex(center, uvHeight);
+	int32 previousIndex = FindOrAddVertex(verts[0], uvHeight);
+	const int32 firstIndex = previousIndex;
+	for (int i = 1; i < verts.Num(); i++) {
+		const int32 currentIndex = FindOrAddVertex(verts[i], uvHeight);
+		Buffers.Triangles.Add(UE::Geometry::FIndex3i(centerIndex, previousIndex, currentIndex));
+		previousIndex = currentIndex;
+	}
+	// Complete the circle
+	Buffers.Triangles.Add(UE::Geometry::FIndex3i(centerIndex, previousIndex, firstIndex));
+}
+
+void FNavMeshRenderTileBuilder::AddConvexFan(const TArray<FVector>& verts, float uvHeight) {
+	// Same winding as the center fan.
+	const int32 firstIndex = FindOrAddVertex(verts[0], uvHeight);
+	int32 previousIndex = FindOrAddVertex(verts[1], uvHeight);
+	for (int i = 2; i < verts.Num(); i++) {
+		const int32 currentIndex = FindOrAddVertex(verts[i], uvHeight);
+		Buffers.Triangles.Add(UE::Geometry::FIndex3i(firstIndex, previousIndex, currentIndex));
+		previousIndex = currentIndex;
+	}
+}
+
+void FNavMeshRenderTileBuilder::AddDetailTriangles(const TArray<FVector>& detailTriangles, float uvHeight) {
+	// The floor still comes from the poly center so a poly never gets split across floors.
+	for (int i = 0; i + 2 < detailTriangles.Num(); i += 3) {
+		Buffers.Triangles.Add(UE::Geometry::FIndex3i(
+			FindOrAddVertex(detailTriangles[i], uvHeight),
+			FindOrAddVertex(detailTriangles[i + 1], uvHeight),
+			FindOrAddVertex(detailTriangles[i + 2], uvHeight)));
+	}
+}
+
+int32 FNavMeshRenderTileBuilder::FindOrAddVertex(const FVector& location, float uvHeight) {
+	const int32 floor = Layout.GetFloor(uvHeight);
+	const FNavMeshRenderVertexKey key(location, floor);
+	if (const int32* existing = LocalVertices.Find(key)) {
+		return *existing;
+	}
+	const int32 retVal = Buffers.Positions.Add(location + FVector(0.f, 0.f, Layout.ZOffset));
+	Buffers.UVs.Add(Layout.UVCoord(location, uvHeight));
+	Buffers.Floors.Add(floor);
+	Buffers.BorderVertices.Add(IsOnTileBorder(location));
+	LocalVertices.Add(key, retVal);
+	return retVal;
+}
+
+bool FNavMeshRenderTileBuilder::IsOnTileBorder(const FVector& location) const {
+	if (!TileBounds.IsValid) {
+		return true;
+	}
+	return FMath::Abs(location.X - TileBounds.Min.X) <= TileBorderTolerance
+		|| FMath::Abs(location.X - TileBounds.Max.X) <= TileBorderTolerance
+		|| FMath::Abs(location.Y - TileBounds.Min.Y) <= TileBorderTolerance
+		|| FMath::Abs(location.Y - TileBounds.Max.Y) <= TileBorderTolerance;
+}
+
+FNavMeshRenderMeshWriter::FNavMeshRenderMeshWriter(UE::Geometry::FDynamicMesh3& mesh, FNavMeshRenderMeshState& state, const FNavMeshRenderLayout& layout)
+	: Mesh(mesh)
+	, State(state)
+	, Layout(layout) {
+	if (Mesh.HasAttributes()) {
+		UVOverlay = Mesh.Attributes()->PrimaryUV();
+		ColorOverlay = Mesh.Attributes()->PrimaryColors();
+		if (Mesh.Attributes()->NumUVLayers() > 1) {
+			HighlightOverlay = Mesh.Attributes()->GetUVLayer(1);
+		}
+	}
+}
+
+void FNavMeshRenderMeshWriter::AppendTile(const FNavMeshRenderTileSnapshot& tile, const FNavMeshRenderTileBuffers& buffers) {
+	NAVMESHRENDER_SCOPE_CYCLE_COUNTER(STAT_NavMeshRender_AppendTile);
+	INC_DWORD_STAT_BY(STAT_NavMeshRender_VerticesAppended, buffers.Positions.Num());
+	INC_DWORD_STAT_BY(STAT_NavMeshRender_TrianglesAppended, buffers.Triangles.Num());
+	const int32 group = tile.TileIndex;
+	TArray<int32>& tileTriangles = State.TileTriangles.FindOrAdd(tile.TileIndex);
+	State.TileSignatures.Add(tile.TileIndex, tile.Signature);
+	State.TileDataHashes.Add(tile.TileIndex, tile.DataHash);
+	LocalToMesh.Reset();
+	LocalToMesh.AddUninitialized(buffers.Positions.Num());
+	ColorElements.Reset();
+	HighlightElements.Reset();
+	for (int32 i = 0; i < buffers.Positions.Num(); i++) {
+		if (!buffers.BorderVertices[i]) {
+			LocalToMesh[i] = AppendVertex(buffers, i);
+			continue;
+		}
+		const FNavMeshRenderVertexKey key(buffers.Positions[i], buffers.Floors[i]);
+		if (const int32* welded = State.BorderVertices.Find(key)) {
+			LocalToMesh[i] = *welded;
+			continue;
+		}
+		LocalToMesh[i] = AppendVertex(buffers, i);
+		State.BorderVertices.Add(key, LocalToMesh[i]);
+		State.BorderVertexKeys.Add(LocalToMesh[i], key);
+	}
+	tileTriangles.Reserve(tileTriangles.Num() + buffers.Triangles.Num());
+	for (int32 t = 0; t < buffers.Triangles.Num(); t++) {
+		const UE::Geometry::FIndex3i& tri = buffers.Triangles[t];
+		const uint32 packedArea = buffers.TriangleAreas.IsValidIndex(t) ? buffers.TriangleAreas[t] : 0;
+		const FVector2f highlightTexel(Layout.GetHighlightTexel(tile.TileIndex, buffers.TrianglePolyIndices.IsValidIndex(t) ? buffers.TrianglePolyIndices[t] : 0));
+		int32 tid = AppendTriangle(LocalToMesh[tri.A], LocalToMesh[tri.B], LocalToMesh[tri.C], group, packedArea, highlightTexel);
+		if (tid == UE::Geometry::FDynamicMesh3::NonManifoldID) {
+			// Overlapping nav layers can weld into a non-manifold edge. Give that triangle its own verts instead.
+			const UE::Geometry::FIndex3i ownVerts{ AppendVertex(buffers, tri.A), AppendVertex(buffers, tri.B), AppendVertex(buffers, tri.C) };
+			tid = AppendTriangle(ownVerts.A, ownVerts.B, ownVerts.C, group, packedArea, highlightTexel);
+			if (tid < 0) {
+				// Nothing else uses the new verts, so they are removed again rather than left behind without a tile.
+				for (int32 k = 0; k < 3; k++) {
+					RemoveVertex(ownVerts[k]);
+				}
+			}
+		}
+		if (tid >= 0) {
+			tileTriangles.Add(tid);
+		}
+	}
+}
+
+void FNavMeshRenderMeshWriter::RemoveTile(int32 tileIndex) {
+	NAVMESHRENDER_SCOPE_CYCLE_COUNTER(STAT_NavMeshRender_RemoveTile);
+	State.TileSignatures.Remove(tileIndex);
+	State.TileDataHashes.Remove(tileIndex);
+	TArray<int32> tileTriangles;
+	if (!State.TileTriangles.RemoveAndCopyValue(tileIndex, tileTriangles)) {
+		return;
+	}
+	TArray<int32> touchedVertices;
+	touchedVertices.Reserve(tileTriangles.Num() * 3);
+	for (int32 tid : tileTriangles) {
+		if (!Mesh.IsTriangle(tid)) {
+			continue;
+		}
+		const UE::Geometry::FIndex3i tri = Mesh.GetTriangle(tid);
+		touchedVertices.Add(tri.A);
+		touchedVertices.Add(tri.B);
+		touchedVertices.Add(tri.C);
+		Mesh.RemoveTriangle(tid, true, false);
+	}
+	// Vertex IDs are recycled by the mesh, so forget any that were removed along with their triangles.
+	for (int32 vid : touchedVertices) {
+		if (Mesh.IsVertex(vid)) {
+			continue;
+		}
+		FNavMeshRenderVertexKey key;
+		if (State.BorderVertexKeys.RemoveAndCopyValue(vid, key)) {
+			State.BorderVertices.Remove(key);
+		}
+		if (State.VertexUVElements.IsValidIndex(vid)) {
+			State.VertexUVElements[vid] = INDEX_NONE;
+		}
+	}
+}
+
+int32 FNavMeshRenderMeshWriter::AppendVertex(const FNavMeshRenderTileBuffers& buffers, int32 localIndex) {
+	// UVs only live in the overlay. Normals are never stored, the render is flat.
+	const int32 retVal = Mesh.AppendVertex(buffers.Positions[localIndex]);
+	if (UVOverlay) {
+		if (State.VertexUVElements.Num() <= retVal) {
+			State.VertexUVElements.SetNum(retVal + 1);
+		}
+		State.VertexUVElements[retVal] = UVOverlay->AppendElement(buffers.UVs[localIndex]);
+	}
+	return retVal;
+}
+
+void FNavMeshRenderMeshWriter::RemoveVertex(int32 vid) {
+	if (UVOverlay && State.VertexUVElements.IsValidIndex(vid) && State.VertexUVElements[vid] != INDEX_NONE) {
+		const TSet<int> unusedElements = { State.VertexUVElements[vid] };
+		UVOverlay->FreeUnusedElements(&unusedElements);
+		State.VertexUVElements[vid] = INDEX_NONE;
+	}
+	Mesh.RemoveVertex(vid);
+}
+
+int32 FNavMeshRenderMeshWriter::AppendTriangle(int32 a, int32 b, int32 c, int32 group, uint32 packedArea, const FVector2f& highlightTexel) {
+	const int32 retVal = Mesh.AppendTriangle(a, b, c, group);
+	if (UVOverlay && retVal >= 0) {
+		UVOverlay->SetTriangle(retVal, UE::Geometry::FIndex3i(State.VertexUVElements[a], State.VertexUVElements[b], State.VertexUVElements[c]));
+	}
+	// Areas are per poly, so a vertex shared by polys of different areas gets one color element per area.
+	if (ColorOverlay && retVal >= 0) {
+		ColorOverlay->SetTriangle(retVal, UE::Geometry::FIndex3i(FindOrAddColorElement(a, packedArea), FindOrAddColorElement(b, packedArea), FindOrAddColorElement(c, packedArea)));
+	}
+	// Same for polys, every corner of a poly's triangles holds the same highlight texel.
+	if (HighlightOverlay && retVal >= 0) {
+		HighlightOverlay->SetTriangle(retVal, UE::Geometry::FIndex3i(FindOrAddHighlightElement(a, highlightTexel), FindOrAddHighlightElement(b, highlightTexel), FindOrAddHighlightElement(c, highlightTexel)));
+	}
+	return retVal;
+}
+
+int32 FNavMeshRenderMeshWriter::FindOrAddColorElement(int32 vid, uint32 packedArea) {
+	const uint64 key = ((uint64)packedArea << 32) | (uint32)vid;
+	if (const int32* existing = ColorElements.Find(key)) {
+		return *existing;
+	}
+	const int32 retVal = ColorOverlay->AppendElement(NavMeshRender::EncodeArea(packedArea));
+	ColorElements.Add(key, retVal);
+	return retVal;
+}
+
+int32 FNavMeshRenderMeshWriter::FindOrAddHighlightElement(int32 vid, const FVector2f& highlightTexel) {
+	// Every poly has its own texel, so the texel's index within the texture tells them apart.
+	const uint32 texelIndex = (uint32)highlightTexel.Y * FNavMeshRenderLayout::HighlightTextureWidth + (uint32)highlightTexel.X;
+	const uint64 key = ((uint64)texelIndex << 32) | (uint32)vid;
+	if (const int32* existing = HighlightElements.Find(key)) {
+		return *existing;
+	}
+	const int32 retVal = HighlightOverlay->AppendElement(highlightTexel);
+	HighlightElements.Add(key, retVal);
+	return retVal;
+}
+
+FNavMeshRenderTimeSlicedBuild::FNavMeshRenderTimeSlicedBuild(const FNavMeshRenderLayout& layout, int32 chunkSizeInTiles, int32 tileCount)
+	: Layout(layout)
+	, ChunkSizeInTiles(chunkSizeInTiles)
+	, TileCount(tileCount) {
+	FinishedPolys.Reserve(tileCount * 16);
+}
+
+void FNavMeshRenderTimeSlicedBuild::AddAgent(FName agentName, const ARecastNavMesh& agentNavMesh) {
+	FNavMeshRenderAgentBuild& agentBuild = AgentBuilds.AddDefaulted_GetRef();
+	agentBuild.AgentName = agentName;
+	agentBuild.State = MakeShared<FNavMeshRenderMeshState>();
+	// Highlights address the main nav mesh's polys, so agents never get the highlight layer.
+	NavMeshRender::InitRenderMesh(agentBuild.Mesh);
+	AgentNavMeshes.Add(&agentNavMesh);
+	AgentTileCounts.Add(agentNavMesh.GetNavMeshTilesCount());
+	AgentTileCount += AgentTileCounts.Last();
+}
+
+void FNavMeshRenderTimeSlicedBuild::BuildNextTile(const ARecastNavMesh& navMesh) {
+	if (IsFinished()) {
+		return;
+	}
+	if (NextTile >= TileCount) {
+		BuildNextAgentTile();
+		return;
+	}
+	const int32 tileIndex = NextTile++;
+	if (!NavMeshRender::GatherTile(navMesh, tileIndex, Layout.Triangulation, FinishedPolys, Tile)) {
+		return;
+	}
+	NavMeshRender::BuildTile(Layout, Tile, TileBuffers);
+	const FIntPoint chunkCoord = NavMeshRender::GetChunkCoord(Tile, ChunkSizeInTiles);
+	int32& chunkIndex = ChunkIndices.FindOrAdd(chunkCoord, INDEX_NONE);
+	if (chunkIndex == INDEX_NONE) {
+		chunkIndex = Chunks.AddDefaulted();
+		Chunks[chunkIndex].Coord = chunkCoord;
+		Chunks[chunkIndex].State = MakeShared<FNavMeshRenderMeshState>();
+		NavMeshRender::InitRenderMesh(Chunks[chunkIndex].Mesh, Layout.bPolyHighlights);
+	}
+	FNavMeshRenderChunk& chunk = Chunks[chunkIndex];
+	FNavMeshRenderMeshWriter(chunk.Mesh, *chunk.State, Layout).AppendTile(Tile, TileBuffers);
+	NavMeshRender::BuildTileIndex(Layout, Tile, TileBuffers, chunk.TileIndices.AddDefaulted_GetRef());
+}
+
+void FNavMeshRenderTimeSlicedBuild::BuildNextAgentTile() {
+	if (NextAgentTile == 0) {
+		FinishedPolys.Reset();
+	}
+	const ARecastNavMesh* agentNavMesh = AgentNavMeshes[NextAgent].Get();
+	const int32 agentTileCount = AgentTileCounts[NextAgent];
+	if (!IsValid(agentNavMesh)) {
+		AgentTilesBuilt += agentTileCount - NextAgentTile;
+		NextAgentTile = agentTileCount;
+	}
+	else if (NextAgentTile < agentTileCount) {
+		const int32 tileIndex = NextAgentTile++;
+		AgentTilesBuilt++;
+		if (NavMeshRender::GatherTile(*agentNavMesh, tileIndex, Layout.Triangulation, FinishedPolys, Tile)) {
+			NavMeshRender::BuildTile(Layout, Tile, TileBuffers);
+			FNavMeshRenderAgentBuild& agentBuild = AgentBuilds[NextAgent];
+			FNavMeshRenderMeshWriter(agentBuild.Mesh, *agentBuild.State, Layout).AppendTile(Tile, TileBuffers);
+		}
+	}
+	if (NextAgentTile >= agentTileCount) {
+		NextAgent++;
+		NextAgentTile = 0;
+	}
+}
+
+float FNavMeshRenderTimeSlicedBuild::GetProgress() const {
+	const int32 totalTiles = TileCount + AgentTileCount;
+	return totalTiles > 0 ? (float)(FMath::Min(NextTile, TileCount) + AgentTilesBuilt) / (float)totalTiles : 1.f;
+}
+
+TArray<FNavMeshRenderChunk> FNavMeshRenderTimeSlicedBuild::TakeChunks() {
+	return MoveTemp(Chunks);
+}
+
+TArray<FNavMeshRenderAgentBuild> FNavMeshRenderTimeSlicedBuild::TakeAgentBuilds() {
+	AgentNavMeshes.Reset();
+	return MoveTemp(AgentBuilds);
+}
+
+void FNavMeshRenderOutline::Reset(bool bTileEdges, bool bOffMeshLinks) {
+	Tiles.Reset();
+	bHasTileEdges = bTileEdges;
+	bHasOffMeshLinks = bOffMeshLinks;
+}
+
+void FNavMeshRenderOutline::GatherTile(const ARecastNavMesh& navMesh, int32 tileIndex, TFunctionRef<bool(int32)> isTileDrawn) {
+	FTile tile;
+	int32 tileLayer = 0;
+	NavMeshRender::GatherTileOutline(navMesh, tileIndex, bHasTileEdges, bHasOffMeshLinks, isTileDrawn, tile.Edges);
+	// Tiles without edges are kept as well, their coordinate finds their neighbors once they detach.
+	if (!navMesh.GetNavMeshTileXY(tileIndex, tile.Coord.X, tile.Coord.Y, tileLayer)) {
+		Tiles.Remove(tileIndex);
+		return;
+	}
+	Tiles.Add(tileIndex, MoveTemp(tile));
+}
+
+void FNavMeshRenderOutline::RemoveTile(int32 tileIndex) {
+	Tiles.Remove(tileIndex);
+}
+
+void FNavMeshRenderOutline::GetTilesWithNeighbors(const ARecastNavMesh& navMesh, const TArray<int32>& tileIndices, TSet<int32>& outTileIndices) const {
+	static const FIntPoint neighborOffsets[] = { FIntPoint(1, 0), FIntPoint(-1, 0), FIntPoint(0, 1), FIntPoint(0, -1) };
+	TArray<int32> neighborTiles;
+	for (int32 tileIndex : tileIndices) {
+		outTileIndices.Add(tileIndex);
+		FIntPoint coord;
+		int32 tileLayer = 0;
+		if (!navMesh.GetNavMeshTileXY(tileIndex, coord.X, coord.Y, tileLayer)) {
+			const FTile* detached = Tiles.Find(tileIndex);
+			if (!detached) {
+				continue;
+			}
+			coord = detached->Coord;
+		}
+		for (const FIntPoint& neighborOffset : neighborOffsets) {
+			neighborTiles.Reset();
+			navMesh.GetNavMeshTilesAt(coord.X + neighborOffset.X, coord.Y + neighborOffset.Y, neighborTiles);
+			outTileIndices.Append(neighborTiles);
+		}
+	}
+}
+
+void FNavMeshRenderOutline::GetLines(float zOffset, float thickness, const FLinearColor& boundaryColor, const FLinearColor& tileEdgeColor, const FLinearColor& offMeshLinkColor, TArray<FBatchedLine>& outLines) const {
+	outLines.Reset();
+	const FVector offset(0.f, 0.f, zOffset + OutlineZBias);
+	for (const TPair<int32, FTile>& tile : Tiles) {
+		for (const FNavMeshRenderEdge& edge : tile.Value.Edges) {
+			const FLinearColor& color = edge.Type == ENavMeshRenderEdgeType::Boundary ? boundaryColor
+				: edge.Type == ENavMeshRenderEdgeType::TileEdge ? tileEdgeColor : offMeshLinkColor;
+			// A life time of 0 keeps the line until the component is flushed.
+			outLines.Emplace(edge.Start + offset, edge.End + offset, color, 0.f, thickness, SDPG_World);
+		}
+	}
+}
+
+void FNavMeshRenderTileCache::SetLayout(const FNavMeshRenderLayout& layout) {
+	// UVs, floors and the Z offset are all baked into the buffers.
+	if (Layout != layout) {
+		Reset();
+		Layout = layout;
+	}
+}
+
+void FNavMeshRenderTileCache::SetMaxTiles(int32 maxTiles) {
+	MaxTiles = FMath::Max(maxTiles, 0);
+	while (KeyOrder.Num() > MaxTiles) {
+		Tiles.Remove(KeyOrder[0]);
+		KeyOrder.RemoveAt(0);
+	}
+}
+
+bool FNavMeshRenderTileCache::FindTile(const ARecastNavMesh& navMesh, int32 tileIndex, FNavMeshRenderTileSnapshot& outTile, FNavMeshRenderTileBuffers& outBuffers) const {
+	if (Tiles.IsEmpty()) {
+		return false;
+	}
+	int32 tileX = 0;
+	int32 tileY = 0;
+	int32 tileLayer = 0;
+	const uint32 dataHash = NavMeshRender::GetTileDataHash(navMesh, tileIndex);
+	if (dataHash == 0 || !navMesh.GetNavMeshTileXY(tileIndex, tileX, tileY, tileLayer)) {
+		return false;
+	}
+	const FNavMeshRenderTileBuffers* cached = Tiles.Find(GetKey(tileX, tileY, dataHash));
+	if (!cached) {
+		return false;
+	}
+	outTile.TileIndex = tileIndex;
+	outTile.Signature = NavMeshRender::GetTileSignature(navMesh, tileIndex);
+	outTile.DataHash = dataHash;
+	outTile.TileX = tileX;
+	outTile.TileY = tileY;
+	outTile.Bounds = navMesh.GetNavMeshTileBounds(tileIndex);
+	outTile.Polys.Reset();
+	outBuffers = *cached;
+	NavMeshRender::RemapTilePolys(navMesh, tileIndex, outBuffers);
+	return true;
+}
+
+void FNavMeshRenderTileCache::AddTile(const FNavMeshRenderTileSnapshot& tile, FNavMeshRenderTileBuffers&& buffers) {
+	if (MaxTiles <= 0 || tile.DataHash == 0 || buffers.Triangles.IsEmpty()) {
+		return;
+	}
+	const uint64 key = GetKey(tile.TileX, tile.TileY, tile.DataHash);
+	// Re-adding a tile makes it the newest.
+	KeyOrder.Remove(key);
+	KeyOrder.Add(key);
+	Tiles.Add(key, MoveTemp(buffers));
+	SetMaxTiles(MaxTiles);
+}
+
+void FNavMeshRenderTileCache::Reset() {
+	Tiles.Reset();
+	KeyOrder.Reset();
+}
+
+SIZE_T FNavMeshRenderTileCache::GetAllocatedSize() const {
+	SIZE_T retVal = Tiles.GetAllocatedSize() + KeyOrder.GetAllocatedSize();
+	for (const TPair<uint64, FNavMeshRenderTileBuffers>& tile : Tiles) {
+		const FNavMeshRenderTileBuffers& buffers = tile.Value;
+		retVal += buffers.Positions.GetAllocatedSize() + buffers.UVs.GetAllocatedSize() + buffers.Floors.GetAllocatedSize() + buffers.BorderVertices.GetAllocatedSize()
+			+ buffers.Triangles.GetAllocatedSize() + buffers.TrianglePolys.GetAllocatedSize() + buffers.TrianglePolyIndices.GetAllocatedSize() + buffers.TriangleAreas.GetAllocatedSize();
+	}
+	return retVal;
+}
+
+uint64 FNavMeshRenderTileCache::GetKey(int32 tileX, int32 tileY, uint32 dataHash) {
+	// The data hash alone could collide between tiles, the coordinate makes that far less likely.
+	return ((uint64)GetTypeHash(FIntPoint(tileX, tileY)) << 32) | dataHash;
+}
+
+uint32 NavMeshRender::PackArea(uint8 area, uint16 flags) {
+	return (uint32)area | ((uint32)flags << 8);
+}
+
+FVector4f NavMeshRender::EncodeArea(uint32 packedArea) {
+	return FVector4f(
+		(float)(packedArea & 0xFF) / 255.f,
+		(float)((packedArea >> 8) & 0xFF) / 255.f,
+		(float)((packedArea >> 16) & 0xFF) / 255.f,
+		1.f);
+}
+
+void NavMeshRender::InitRenderMesh(UE::Geometry::FDynamicMesh3& mesh, bool bPolyHighlights) {
+	mesh.Clear();
+	mesh.EnableAttributes();
+	mesh.Attributes()->SetNumUVLayers(bPolyHighlights ? 2 : 1);
+	mesh.Attributes()->EnablePrimaryColors();
+	mesh.EnableTriangleGroups();
+}
+
+FIntPoint NavMeshRender::GetChunkCoord(const FNavMeshRenderTileSnapshot& tile, int32 chunkSizeInTiles) {
+	return GetChunkCoord(tile.TileX, tile.TileY, chunkSizeInTiles);
+}
+
+FIntPoint NavMeshRender::GetChunkCoord(int32 tileX, int32 tileY, int32 chunkSizeInTiles) {
+	if (chunkSizeInTiles <= 0) {
+		return FIntPoint::ZeroValue;
+	}
+	return FIntPoint(
+		FMath::FloorToInt((float)tileX / (float)chunkSizeInTiles),
+		FMath::FloorToInt((float)tileY / (float)chunkSizeInTiles));
+}
+
+uint64 NavMeshRender::GetTileSignature(const ARecastNavMesh& navMesh, int32 tileIndex) {
+#if WITH_RECAST
+	const dtNavMesh* detourMesh = navMesh.GetRecastMesh();
+	if (!detourMesh || tileIndex < 0 || tileIndex >= detourMesh->getMaxTiles()) {
+		return 0;
+	}
+	const dtMeshTile* tile = detourMesh->getTile(tileIndex);
+	if (!tile || !tile->header) {
+		return 0;
+	}
+	// The tile ref carries the tile salt, which Detour bumps every time the tile is removed or replaced.
+	return (uint64)detourMesh->getTileRef(tile);
+#else
+	return 0;
+#endif
+}
+
+int32 NavMeshRender::GetHighlightTileStride(const ARecastNavMesh& navMesh) {
+	int32 maxPolys = 16;
+#if WITH_RECAST
+	const dtNavMesh* detourMesh = navMesh.GetRecastMesh();
+	if (!detourMesh) {
+		return maxPolys;
+	}
+	for (int32 tileIndex = 0; tileIndex < detourMesh->getMaxTiles(); tileIndex++) {
+		const dtMeshTile* tile = detourMesh->getTile(tileIndex);
+		if (tile && tile->header) {
+			maxPolys = FMath::Max(maxPolys, (int32)tile->header->polyCount);
+		}
+	}
+#endif
+	// A power of two leaves room for tiles to gain polys, and below the texture width it never splits a tile across rows.
+	return (int32)FMath::RoundUpToPowerOfTwo((uint32)maxPolys);
+}
+
+uint32 NavMeshRender::GetTileDataHash(const ARecastNavMesh& navMesh, int32 tileIndex) {
+#if WITH_RECAST
+	const dtNavMesh* detourMesh = navMesh.GetRecastMesh();
+	if (!detourMesh || tileIndex < 0 || tileIndex >= detourMesh->getMaxTiles()) {
+		return 0;
+	}
+	const dtMeshTile* tile = detourMesh->getTile(tileIndex);
+	if (!tile || !tile->header || !tile->data) {
+		return 0;
+	}
+	return FCrc::MemCrc32(tile->data, tile->dataSize);
+#else
+	return 0;
+#endif
+}
+
+uint32 NavMeshRender::GetTileHashContribution(int32 tileIndex, uint32 dataHash) {
+	return dataHash == 0 ? 0 : HashCombine(::GetTypeHash(tileIndex), dataHash);
+}
+
+uint32 NavMeshRender::GetNavDataHash(const ARecastNavMesh& navMesh) {
+	uint32 retVal = 0;
+	const int tileCount = navMesh.GetNavMeshTilesCount();
+	for (int32 v = 0; v < tileCount; v++) {
+		retVal ^= GetTileHashContribution(v, GetTileDataHash(navMesh, v));
+	}
+	return retVal;
+}
+
+uint32 NavMeshRender::GetNavDataHash(const FNavMeshRenderMeshState& state) {
+	uint32 retVal = 0;
+	for (const TPair<int32, uint32>& tileHash : state.TileDataHashes) {
+		retVal ^= GetTileHashContribution(tileHash.Key, tileHash.Value);
+	}
+	return retVal;
+}
+
+bool NavMeshRender::GatherTile(const ARecastNavMesh& navMesh, int32 tileIndex, ENavMeshRenderTriangulation triangulation, TSet<NavNodeRef>& finishedPolys, FNavMeshRenderTileSnapshot& outTile) {
+	NAVMESHRENDER_SCOPE_CYCLE_COUNTER(STAT_NavMeshRender_GatherTile);
+	TArray<FNavPoly> currentPolys;
+	if (!navMesh.GetPolysInTile(tileIndex, currentPolys)) {
+		return false;
+	}
+	outTile.TileIndex = tileIndex;
+	outTile.Signature = GetTileSignature(navMesh, tileIndex);
+	outTile.DataHash = GetTileDataHash(navMesh, tileIndex);
+	int32 tileLayer = 0;
+	if (!navMesh.GetNavMeshTileXY(tileIndex, outTile.TileX, outTile.TileY, tileLayer)) {
+		outTile.TileX = 0;
+		outTile.TileY = 0;
+	}
+	outTile.Bounds = navMesh.GetNavMeshTileBounds(tileIndex);
+	outTile.Polys.Reset(currentPolys.Num());
+	TArray<FVector> currentVerts;
+#if WITH_RECAST
+	const dtNavMesh* detourMesh = navMesh.GetRecastMesh();
+#endif
+	for (const FNavPoly& poly : currentPolys) {
+		bool bAlreadyAdded = false;
+		finishedPolys.Add(poly.Ref, &bAlreadyAdded);
+		if (bAlreadyAdded) {
+			continue;
+		}
+		if (!navMesh.GetPolyVerts(poly.Ref, currentVerts)) {
+			continue;
+		}
+		FNavMeshRenderPolySnapshot& polySnapshot = outTile.Polys.AddDefaulted_GetRef();
+		polySnapshot.Ref = poly.Ref;
+#if WITH_RECAST
+		polySnapshot.PolyIndex = detourMesh ? (int32)detourMesh->decodePolyIdPoly((dtPolyRef)poly.Ref) : 0;
+#endif
+		polySnapshot.Center = poly.Center;
+		polySnapshot.Verts = currentVerts;
+		uint16 polyFlags = 0;
+		uint16 areaFlags = 0;
+		navMesh.GetPolyFlags(poly.Ref, polyFlags, areaFlags);
+		polySnapshot.Area = (uint8)navMesh.GetPolyAreaID(poly.Ref);
+		polySnapshot.Flags = polyFlags;
+		if (triangulation == ENavMeshRenderTriangulation::DetailMesh) {
+			GetPolyDetailTriangles(navMesh, poly.Ref, polySnapshot.DetailTriangles);
+		}
+	}
+	return true;
+}
+
+void NavMeshRender::GatherTileOutline(const ARecastNavMesh& navMesh, int32 tileIndex, bool bTileEdges, bool bOffMeshLinks, TFunctionRef<bool(int32)> isTileDrawn, TArray<FNavMeshRenderEdge>& outEdges) {
+	outEdges.Reset();
+#if WITH_RECAST
+	const dtNavMesh* detourMesh = navMesh.GetRecastMesh();
+	if (!detourMesh || tileIndex < 0 || tileIndex >= detourMesh->getMaxTiles()) {
+		return;
+	}
+	const dtMeshTile* tile = detourMesh->getTile(tileIndex);
+	if (!tile || !tile->header) {
+		return;
+	}
+	for (int32 p = 0; p < tile->header->polyCount; p++) {
+		const dtPoly& poly = tile->polys[p];
+		if (poly.getType() == DT_POLYTYPE_OFFMESH_POINT) {
+			if (bOffMeshLinks && poly.vertCount >= 2) {
+				outEdges.Add({ Recast2UnrealPoint(&tile->verts[poly.verts[0] * 3]), Recast2UnrealPoint(&tile->verts[poly.verts[1] * 3]), ENavMeshRenderEdgeType::OffMeshLink });
+			}
+			continue;
+		}
+		if (poly.getType() != DT_POLYTYPE_GROUND) {
+			continue;
+		}
+		for (int32 j = 0; j < poly.vertCount; j++) {
+			const unsigned short neighbor = poly.neis[j];
+			ENavMeshRenderEdgeType edgeType = ENavMeshRenderEdgeType::Boundary;
+			if (neighbor & DT_EXT_LINK) {
+				// Portal edges are only open where a neighboring tile is attached and linked.
+				int32 neighborTile = INDEX_NONE;
+				for (unsigned int k = poly.firstLink; k != DT_NULL_LINK; k = detourMesh->getLink(tile, k).next) {
+					const dtLink& link = detourMesh->getLink(tile, k);
+					if (link.edge == j) {
+						neighborTile = (int32)detourMesh->decodePolyIdTile(link.ref);
+						break;
+					}
+				}
+				if (neighborTile != INDEX_NONE) {
+					if (!bTileEdges || (neighborTile < tileIndex && isTileDrawn(neighborTile))) {
+						continue;
+					}
+					edgeType = ENavMeshRenderEdgeType::TileEdge;
+				}
+			}
+			else if (neighbor != 0) {
+				// Shared with a poly of the same tile.
+				continue;
+			}
+			outEdges.Add({ Recast2UnrealPoint(&tile->verts[poly.verts[j] * 3]), Recast2UnrealPoint(&tile->verts[poly.verts[(j + 1) % poly.vertCount] * 3]), edgeType });
+		}
+	}
+#endif
+}
+
+void NavMeshRender::RemapTilePolys(const ARecastNavMesh& navMesh, int32 tileIndex, FNavMeshRenderTileBuffers& buffers) {
+#if WITH_RECAST
+	const dtNavMesh* detourMesh = navMesh.GetRecastMesh();
+	if (!detourMesh || tileIndex < 0 || tileIndex >= detourMesh->getMaxTiles()) {
+		return;
+	}
+	const dtMeshTile* tile = detourMesh->getTile(tileIndex);
+	if (!tile || !tile->header) {
+		return;
+	}
+	// A poly ref is the tile's base ref plus the poly's index within the tile, and the index doesn't change with the tile data.
+	const dtPolyRef polyRefBase = detourMesh->getPolyRefBase(tile);
+	for (NavNodeRef& polyRef : buffers.TrianglePolys) {
+		polyRef = (NavNodeRef)(polyRefBase | (dtPolyRef)detourMesh->decodePolyIdPoly((dtPolyRef)polyRef));
+	}
+#endif
+}
+
+bool NavMeshRender::GetPolyDetailTriangles(const ARecastNavMesh& navMesh, NavNodeRef polyRef, TArray<FVector>& outTriangles) {
+	outTriangles.Reset();
+#if WITH_RECAST
+	const dtNavMesh* detourMesh = navMesh.GetRecastMesh();
+	const dtMeshTile* tile = nullptr;
+	const dtPoly* poly = nullptr;
+	if (!detourMesh || dtStatusFailed(detourMesh->getTileAndPolyByRef(polyRef, &tile, &poly))) {
+		return false;
+	}
+	if (!tile->detailMeshes || poly->getType() != DT_POLYTYPE_GROUND) {
+		return false;
+	}
+	const dtPolyDetail& polyDetail = tile->detailMeshes[poly - tile->polys];
+	outTriangles.Reserve(polyDetail.triCount * 3);
+	for (int32 i = 0; i < polyDetail.triCount; i++) {
+		const unsigned char* detailTri = &tile->detailTris[(polyDetail.triBase + i) * 4];
+		for (int32 k = 0; k < 3; k++) {
+			// Indices below the poly's vert count refer to the poly verts, the rest to the detail verts.
+			const dtReal* recastVert = detailTri[k] < poly->vertCount
+				? &tile->verts[poly->verts[detailTri[k]] * 3]
+				: &tile->detailVerts[(polyDetail.vertBase + detailTri[k] - poly->vertCount) * 3];
+			outTriangles.Add(Recast2UnrealPoint(recastVert));
+		}
+	}
+	return outTriangles.Num() > 0;
+#else
+	return false;
+#endif
+}
+
+void NavMeshRender::GatherTiles(const ARecastNavMesh& navMesh, ENavMeshRenderTriangulation triangulation, TArray<FNavMeshRenderTileSnapshot>& outTiles) {
+	const int tileCount = navMesh.GetNavMeshTilesCount();
+	outTiles.Reset();
+	outTiles.Reserve(tileCount);
+	// Poly refs are unique per tile and poly index, so they are used to key the dedup instead of the poly center.
+	TSet<NavNodeRef> finishedPolys;
+	finishedPolys.Reserve(tileCount * 16);
+	FNavMeshRenderTileSnapshot tile;
+	for (int32 v = 0; v < tileCount; v++) {
+		if (GatherTile(navMesh, v, triangulation, finishedPolys, tile)) {
+			outTiles.Add(MoveTemp(tile));
+		}
+	}
+}
+
+void NavMeshRender::BuildTile(const FNavMeshRenderLayout& layout, const FNavMeshRenderTileSnapshot& tile, FNavMeshRenderTileBuffers& outBuffers) {
+	NAVMESHRENDER_SCOPE_CYCLE_COUNTER(STAT_NavMeshRender_BuildTile);
+	outBuffers.Reset();
+	FNavMeshRenderTileBuilder tileBuilder(layout, tile.Bounds, outBuffers);
+	for (const FNavMeshRenderPolySnapshot& poly : tile.Polys) {
+		tileBuilder.AddPoly(poly);
+	}
+}
+
+void NavMeshRender::BuildTileIndex(const FNavMeshRenderLayout& layout, const FNavMeshRenderTileSnapshot& tile, const FNavMeshRenderTileBuffers& buffers, FNavMeshRenderTileIndex& outIndex) {
+	NAVMESHRENDER_SCOPE_CYCLE_COUNTER(STAT_NavMeshRender_BuildTileIndex);
+	outIndex.Init(tile.TileIndex, buffers.Positions, buffers.UVs, buffers.Floors, buffers.Triangles, buffers.TrianglePolys, layout.ZOffset);
+}
+
+void NavMeshRender::BuildTileIndices(const FNavMeshRenderLayout& layout, const TArray<FNavMeshRenderTileSnapshot>& tiles, TArray<FNavMeshRenderTileIndex>& outIndices) {
+	outIndices.SetNum(tiles.Num());
+	ParallelFor(tiles.Num(), [&layout, &tiles, &outIndices](int32 i) {
+		FNavMeshRenderTileBuffers tileBuffers;
+		BuildTile(layout, tiles[i], tileBuffers);
+		BuildTileIndex(layout, tiles[i], tileBuffers, outIndices[i]);
+	});
+}
+
+void NavMeshRender::BuildTiles(const FNavMeshRenderLayout& layout, const TArray<FNavMeshRenderTileSnapshot>& tiles, TArray<FNavMeshRenderTileBuffers>& outBuffers) {
+	NAVMESHRENDER_SCOPE_CYCLE_COUNTER(STAT_NavMeshRender_BuildTiles);
+	outBuffers.SetNum(tiles.Num());
+	// Tiles only read the layout and write their own buffers, so they can be triangulated in any order.
+	ParallelFor(tiles.Num(), [&layout, &tiles, &outBuffers](int32 i) {
+		BuildTile(layout, tiles[i], outBuffers[i]);
+	});
+}
+
+void NavMeshRender::BuildMesh(const FNavMeshRenderLayout& layout, const TArray<FNavMeshRenderTileSnapshot>& tiles, UE::Geometry::FDynamicMesh3& outMesh, FNavMeshRenderMeshState& outState) {
+	InitRenderMesh(outMesh, layout.bPolyHighlights);
+	outState.Reset();
+	TArray<FNavMeshRenderTileBuffers> tileBuffers;
+	BuildTiles(layout, tiles, tileBuffers);
+	// Merging in tile order keeps vertex and triangle IDs identical to a serial build.
+	FNavMeshRenderMeshWriter meshWriter(outMesh, outState, layout);
+	for (int32 i = 0; i < tiles.Num(); i++) {
+		meshWriter.AppendTile(tiles[i], tileBuffers[i]);
+	}
+}
+
+void NavMeshRender::BuildChunks(const FNavMeshRenderLayout& layout, const TArray<FNavMeshRenderTileSnapshot>& tiles, int32 chunkSizeInTiles, TArray<FNavMeshRenderChunk>& outChunks) {
+	TArray<FNavMeshRenderTileBuffers> tileBuffers;
+	BuildTiles(layout, tiles, tileBuffers);
+	outChunks.Reset();
+	TMap<FIntPoint, int32> chunkIndices;
+	TArray<TArray<int32>> chunkTiles;
+	for (int32 i = 0; i < tiles.Num(); i++) {
+		const FIntPoint chunkCoord = GetChunkCoord(tiles[i], chunkSizeInTiles);
+		int32& chunkIndex = chunkIndices.FindOrAdd(chunkCoord, INDEX_NONE);
+		if (chunkIndex == INDEX_NONE) {
+			chunkIndex = outChunks.AddDefaulted();
+			outChunks[chunkIndex].Coord = chunkCoord;
+			chunkTiles.AddDefaulted();
+		}
+		chunkTiles[chunkIndex].Add(i);
+	}
+	// Chunks don't share vertices, so each one is merged independently. Tile order within a chunk is kept.
+	ParallelFor(outChunks.Num(), [&](int32 c) {
+		FNavMeshRenderChunk& chunk = outChunks[c];
+		chunk.State = MakeShared<FNavMeshRenderMeshState>();
+		InitRenderMesh(chunk.Mesh, layout.bPolyHighlights);
+		FNavMeshRenderMeshWriter meshWriter(chunk.Mesh, *chunk.State, layout);
+		chunk.TileIndices.SetNum(chunkTiles[c].Num());
+		for (int32 i = 0; i < chunkTiles[c].Num(); i++) {
+			const int32 tileIndex = chunkTiles[c][i];
+			meshWriter.AppendTile(tiles[tileIndex], tileBuffers[tileIndex]);
+			BuildTileIndex(layout, tiles[tileIndex], tileBuffers[tileIndex], chunk.TileIndices[i]);
+		}
+	});
+}
+
+void NavMeshRender::BuildAgentMeshes(const FNavMeshRenderLayout& layout, TArray<FNavMeshRenderAgentBuild>& agentBuilds) {
+	NAVMESHRENDER_SCOPE_CYCLE_COUNTER(STAT_NavMeshRender_BuildTiles);
+	// Agent and tile of every tile, so small agents don't leave workers idle.
+	TArray<FIntPoint> agentTiles;
+	TArray<TArray<FNavMeshRenderTileBuffers>> tileBuffers;
+	tileBuffers.SetNum(agentBuilds.Num());
+	for (int32 a = 0; a < agentBuilds.Num(); a++) {
+		tileBuffers[a].SetNum(agentBuilds[a].Tiles.Num());
+		for (int32 t = 0; t < agentBuilds[a].Tiles.Num(); t++) {
+			agentTiles.Add(FIntPoint(a, t));
+		}
+	}
+	ParallelFor(agentTiles.Num(), [&layout, &agentBuilds, &agentTiles, &tileBuffers](int32 i) {
+		const FIntPoint& agentTile = agentTiles[i];
+		BuildTile(layout, agentBuilds[agentTile.X].Tiles[agentTile.Y], tileBuffers[agentTile.X][agentTile.Y]);
+	});
+	// Agents don't share vertices, so each one is merged independently.
+	ParallelFor(agentBuilds.Num(), [&layout, &agentBuilds, &tileBuffers](int32 a) {
+		FNavMeshRenderAgentBuild& agentBuild = agentBuilds[a];
+		agentBuild.State = MakeShared<FNavMeshRenderMeshState>();
+		// Highlights address the main nav mesh's polys, so agents never get the highlight layer.
+		InitRenderMesh(agentBuild.Mesh);
+		FNavMeshRenderMeshWriter meshWriter(agentBuild.Mesh, *agentBuild.State, layout);
+		for (int32 t = 0; t < agentBuild.Tiles.Num(); t++) {
+			meshWriter.AppendTile(agentBuild.Tiles[t], tileBuffers[a][t]);
+		}
+		agentBuild.Tiles.Empty();
+	});
+}
+
+void NavMeshRender::RebuildTiles(const FNavMeshRenderLayout& layout, const TArray<int32>& dirtyTiles, const TArray<FNavMeshRenderTileSnapshot>& tiles, TArray<FNavMeshRenderTileBuffers>& tileBuffers,
+	UE::Geometry::FDynamicMesh3& mesh, FNavMeshRenderMeshState& state, TArray<FNavMeshRenderTileIndex>& outTileIndices) {
+	{
+		NAVMESHRENDER_SCOPE_CYCLE_COUNTER(STAT_NavMeshRender_BuildTiles);
+		tileBuffers.SetNum(tiles.Num());
+		ParallelFor(tiles.Num(), [&layout, &tiles, &tileBuffers](int32 i) {
+			if (tileBuffers[i].Triangles.IsEmpty()) {
+				BuildTile(layout, tiles[i], tileBuffers[i]);
+			}
+		});
+	}
+	FNavMeshRenderMeshWriter meshWriter(mesh, state, layout);
+	for (int32 tileIndex : dirtyTiles) {
+		meshWriter.RemoveTile(tileIndex);
+	}
+	for (int32 i = 0; i < tiles.Num(); i++) {
+		meshWriter.AppendTile(tiles[i], tileBuffers[i]);
+		BuildTileIndex(layout, tiles[i], tileBuffers[i], outTileIndices.AddDefaulted_GetRef());
+	}
+}
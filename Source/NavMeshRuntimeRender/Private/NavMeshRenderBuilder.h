@@ -0,0 +1,511 @@
+// Cutter H // 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "DynamicMesh/DynamicMesh3.h"
+#include "DynamicMesh/DynamicMeshAttributeSet.h"
+#include "IndexTypes.h"
+#include "NavMeshRenderLayout.h"
+#include "NavMeshRenderSpatialIndex.h"
+
+class ARecastNavMesh;
+struct FBatchedLine;
+
+/*
+ * Identifies a render vertex by its quantized position and floor. Vertices sharing a key are welded.
+ */
+struct FNavMeshRenderVertexKey
+{
+	FNavMeshRenderVertexKey() = default;
+	FNavMeshRenderVertexKey(const FVector& location, int32 floor);
+
+	FIntVector Position = FIntVector::ZeroValue;
+	int32 Floor = 0;
+
+	bool operator==(const FNavMeshRenderVertexKey& other) const {
+		return Position == other.Position && Floor == other.Floor;
+	}
+	friend uint32 GetTypeHash(const FNavMeshRenderVertexKey& key) {
+		return HashCombine(GetTypeHash(key.Position), ::GetTypeHash(key.Floor));
+	}
+};
+
+/*
+ * Copy of a single nav poly, taken on the game thread so it can be triangulated anywhere.
+ */
+struct FNavMeshRenderPolySnapshot
+{
+	NavNodeRef Ref = INVALID_NAVNODEREF;
+	/*
+	* Index of the poly within its Detour tile, which a poly highlight texel is addressed by. See FNavMeshRenderHighlights.
+	*/
+	int32 PolyIndex = 0;
+	FVector Center = FVector::ZeroVector;
+	TArray<FVector> Verts;
+	/*
+	* Recast area ID and poly flags, see NavMeshRender::EncodeArea.
+	*/
+	uint8 Area = 0;
+	uint16 Flags = 0;
+	/*
+	* Recast detail mesh triangles, three verts each. Only gathered for ENavMeshRenderTriangulation::DetailMesh.
+	*/
+	TArray<FVector> DetailTriangles;
+};
+
+/*
+ * Copy of the polys of a single nav tile.
+ */
+struct FNavMeshRenderTileSnapshot
+{
+	int32 TileIndex = INDEX_NONE;
+	/*
+	* Detour tile ref at the time of the snapshot. See NavMeshRender::GetTileSignature.
+	*/
+	uint64 Signature = 0;
+	/*
+	* CRC of the tile's Recast data. See NavMeshRender::GetTileDataHash.
+	*/
+	uint32 DataHash = 0;
+	/*
+	* Tile coordinate in the nav mesh grid. Used to assign tiles to render chunks.
+	*/
+	int32 TileX = 0;
+	int32 TileY = 0;
+	FBox Bounds = FBox(ForceInit);
+	TArray<FNavMeshRenderPolySnapshot> Polys;
+};
+
+/*
+ * Bookkeeping that lets individual tiles be removed from and re-appended to a built mesh.
+ */
+struct FNavMeshRenderMeshState
+{
+	/*
+	* Welded border vertices by key, and the reverse lookup so removed vertices can be forgotten.
+	*/
+	TMap<FNavMeshRenderVertexKey, int32> BorderVertices;
+	TMap<int32, FNavMeshRenderVertexKey> BorderVertexKeys;
+	/*
+	* UV overlay element of each mesh vertex, indexed by vertex ID.
+	*/
+	TArray<int32> VertexUVElements;
+	/*
+	* Mesh triangles owned by each tile, keyed by tile index.
+	*/
+	TMap<int32, TArray<int32>> TileTriangles;
+	/*
+	* Signature of the tile data each tile was built from.
+	*/
+	TMap<int32, uint64> TileSignatures;
+	/*
+	* Data hash of each tile, used to keep the saved render's nav data hash current.
+	*/
+	TMap<int32, uint32> TileDataHashes;
+
+	void Reset();
+};
+
+/*
+ * A built render mesh covering one chunk of tiles, along with its bookkeeping.
+ */
+struct FNavMeshRenderChunk
+{
+	FIntPoint Coord = FIntPoint::ZeroValue;
+	UE::Geometry::FDynamicMesh3 Mesh;
+	TSharedPtr<FNavMeshRenderMeshState> State;
+	/*
+	* Query data of every tile in the chunk, for FNavMeshRenderSpatialIndex.
+	*/
+	TArray<FNavMeshRenderTileIndex> TileIndices;
+};
+
+/*
+ * The tiles of one additional agent's nav mesh and the render mesh built from them.
+ */
+struct FNavMeshRenderAgentBuild
+{
+	FName AgentName;
+	TArray<FNavMeshRenderTileSnapshot> Tiles;
+	UE::Geometry::FDynamicMesh3 Mesh;
+	TSharedPtr<FNavMeshRenderMeshState> State;
+};
+
+/*
+ * Unique vertices and triangles of a single nav tile. Triangles index into the tile's own vertices.
+ */
+struct FNavMeshRenderTileBuffers
+{
+	TArray<FVector> Positions;
+	TArray<FVector2f> UVs;
+	TArray<int32> Floors;
+	/*
+	* Vertices on the tile's XY bounds. Only these are welded against other tiles.
+	*/
+	TArray<bool> BorderVertices;
+	TArray<UE::Geometry::FIndex3i> Triangles;
+	/*
+	* The nav poly each triangle was made from.
+	*/
+	TArray<NavNodeRef> TrianglePolys;
+	/*
+	* Tile index of each triangle's poly. Unlike the refs these stay the same when the tile is attached again.
+	*/
+	TArray<int32> TrianglePolyIndices;
+	/*
+	* Area and flags of each triangle's poly, packed by NavMeshRender::PackArea.
+	*/
+	TArray<uint32> TriangleAreas;
+
+	void Reset();
+};
+
+/*
+ * Triangulates the polys of one tile into FNavMeshRenderTileBuffers, emitting one vertex per unique nav vertex per floor.
+ */
+class FNavMeshRenderTileBuilder
+{
+public:
+	FNavMeshRenderTileBuilder(const FNavMeshRenderLayout& layout, const FBox& tileBounds, FNavMeshRenderTileBuffers& outBuffers);
+	/*
+	* Adds a nav poly, triangulated as the layout asks.
+	*/
+	void AddPoly(const FNavMeshRenderPolySnapshot& poly);
+
+private:
+	void AddCenterFan(const FVector& center, const TArray<FVector>& verts);
+	void AddConvexFan(const TArray<FVector>& verts, float uvHeight);
+	void AddDetailTriangles(const TArray<FVector>& detailTriangles, float uvHeight);
+	int32 FindOrAddVertex(const FVector& location, float uvHeight);
+	bool IsOnTileBorder(const FVector& location) const;
+
+	const FNavMeshRenderLayout& Layout;
+	FBox TileBounds;
+	FNavMeshRenderTileBuffers& Buffers;
+	TMap<FNavMeshRenderVertexKey, int32> LocalVertices;
+};
+
+/*
+ * Appends tile buffers to a dynamic mesh, welding border vertices shared between tiles.
+ * Tiles can later be removed again through the same state.
+ */
+class FNavMeshRenderMeshWriter
+{
+public:
+	FNavMeshRenderMeshWriter(UE::Geometry::FDynamicMesh3& mesh, FNavMeshRenderMeshState& state, const FNavMeshRenderLayout& layout);
+	void AppendTile(const FNavMeshRenderTileSnapshot& tile, const FNavMeshRenderTileBuffers& buffers);
+	/*
+	* Removes every triangle of the tile along with any vertex that is no longer used.
+	*/
+	void RemoveTile(int32 tileIndex);
+
+private:
+	int32 AppendVertex(const FNavMeshRenderTileBuffers& buffers, int32 localIndex);
+	/*
+	* Removes a vertex that no triangle uses, along with its UV element.
+	*/
+	void RemoveVertex(int32 vid);
+	int32 AppendTriangle(int32 a, int32 b, int32 c, int32 group, uint32 packedArea, const FVector2f& highlightTexel);
+	int32 FindOrAddColorElement(int32 vid, uint32 packedArea);
+	int32 FindOrAddHighlightElement(int32 vid, const FVector2f& highlightTexel);
+
+	UE::Geometry::FDynamicMesh3& Mesh;
+	FNavMeshRenderMeshState& State;
+	const FNavMeshRenderLayout& Layout;
+	UE::Geometry::FDynamicMeshUVOverlay* UVOverlay = nullptr;
+	UE::Geometry::FDynamicMeshColorOverlay* ColorOverlay = nullptr;
+	/*
+	* Second UV layer, only there when the mesh was made with poly highlights.
+	*/
+	UE::Geometry::FDynamicMeshUVOverlay* HighlightOverlay = nullptr;
+	TArray<int32> LocalToMesh;
+	/*
+	* Color elements of the current tile by vertex and packed area. Triangles of one area share their corners' elements.
+	*/
+	TMap<uint64, int32> ColorElements;
+	/*
+	* Highlight elements of the current tile by vertex and texel index.
+	*/
+	TMap<uint64, int32> HighlightElements;
+};
+
+/*
+ * Builds render chunks one tile at a time so the work can be spread across frames, then the meshes of any added agents the same way.
+ * The result matches NavMeshRender::BuildChunks and NavMeshRender::BuildAgentMeshes.
+ */
+class FNavMeshRenderTimeSlicedBuild
+{
+public:
+	FNavMeshRenderTimeSlicedBuild(const FNavMeshRenderLayout& layout, int32 chunkSizeInTiles, int32 tileCount);
+	/*
+	* Queues an additional agent's nav mesh, built tile by tile once the main tiles are done.
+	* Agents whose nav mesh goes away before they are built end up without a mesh.
+	*/
+	void AddAgent(FName agentName, const ARecastNavMesh& agentNavMesh);
+	/*
+	* Gathers, triangulates and merges the next tile of the main nav mesh, or of the next agent once those are done.
+	* This reads Recast data and must be called on the game thread.
+	*/
+	void BuildNextTile(const ARecastNavMesh& navMesh);
+	bool IsFinished() const {
+		return NextTile >= TileCount && NextAgent >= AgentBuilds.Num();
+	}
+	float GetProgress() const;
+	/*
+	* Hands over the built chunks. Only valid once finished.
+	*/
+	TArray<FNavMeshRenderChunk> TakeChunks();
+	/*
+	* Hands over the built agent meshes, without their tile snapshots. Only valid once finished.
+	*/
+	TArray<FNavMeshRenderAgentBuild> TakeAgentBuilds();
+
+private:
+	void BuildNextAgentTile();
+
+	FNavMeshRenderLayout Layout;
+	int32 ChunkSizeInTiles = 0;
+	int32 TileCount = 0;
+	int32 NextTile = 0;
+	/*
+	* Polys of the nav mesh being built that were already gathered. Cleared before each agent.
+	*/
+	TSet<NavNodeRef> FinishedPolys;
+	TArray<FNavMeshRenderAgentBuild> AgentBuilds;
+	TArray<TWeakObjectPtr<const ARecastNavMesh>> AgentNavMeshes;
+	TArray<int32> AgentTileCounts;
+	int32 NextAgent = 0;
+	int32 NextAgentTile = 0;
+	int32 AgentTileCount = 0;
+	int32 AgentTilesBuilt = 0;
+	FNavMeshRenderTileSnapshot Tile;
+	FNavMeshRenderTileBuffers TileBuffers;
+	TArray<FNavMeshRenderChunk> Chunks;
+	TMap<FIntPoint, int32> ChunkIndices;
+};
+
+/*
+ * What an outline edge borders.
+ */
+enum class ENavMeshRenderEdgeType : uint8
+{
+	/*
+	* Edge without a neighboring poly.
+	*/
+	Boundary,
+	/*
+	* Edge shared with a poly of a neighboring tile.
+	*/
+	TileEdge,
+	/*
+	* Off-mesh link, from its start to its end.
+	*/
+	OffMeshLink
+};
+
+struct FNavMeshRenderEdge
+{
+	FVector Start = FVector::ZeroVector;
+	FVector End = FVector::ZeroVector;
+	ENavMeshRenderEdgeType Type = ENavMeshRenderEdgeType::Boundary;
+};
+
+/*
+ * Outline edges of every drawn tile, kept per tile so tiles can be swapped individually.
+ */
+class FNavMeshRenderOutline
+{
+public:
+	/*
+	* Forgets every tile and records which optional edges the tiles will be gathered with.
+	*/
+	void Reset(bool bTileEdges, bool bOffMeshLinks);
+	/*
+	* True if the tiles were gathered with these optional edges.
+	*/
+	bool Matches(bool bTileEdges, bool bOffMeshLinks) const {
+		return bHasTileEdges == bTileEdges && bHasOffMeshLinks == bOffMeshLinks;
+	}
+	bool HasTileEdges() const {
+		return bHasTileEdges;
+	}
+	bool HasOffMeshLinks() const {
+		return bHasOffMeshLinks;
+	}
+	/*
+	* Replaces the tile's edges with those currently in the nav mesh, see NavMeshRender::GatherTileOutline. Detached tiles are removed.
+	* This reads Recast data and must be called on the game thread.
+	*/
+	void GatherTile(const ARecastNavMesh& navMesh, int32 tileIndex, TFunctionRef<bool(int32)> isTileDrawn);
+	void RemoveTile(int32 tileIndex);
+	bool IsEmpty() const {
+		return Tiles.IsEmpty();
+	}
+	/*
+	* Adds the tiles whose edges can change along with the given ones: the tiles themselves and every layer of the four tiles next to them.
+	* Tiles that were detached are placed by where they were last gathered.
+	*/
+	void GetTilesWithNeighbors(const ARecastNavMesh& navMesh, const TArray<int32>& tileIndices, TSet<int32>& outTileIndices) const;
+	/*
+	* Every edge as a persistent line, raised by zOffset plus a small bias so it draws over the filled render.
+	*/
+	void GetLines(float zOffset, float thickness, const FLinearColor& boundaryColor, const FLinearColor& tileEdgeColor, const FLinearColor& offMeshLinkColor, TArray<FBatchedLine>& outLines) const;
+
+private:
+	struct FTile
+	{
+		FIntPoint Coord = FIntPoint::ZeroValue;
+		TArray<FNavMeshRenderEdge> Edges;
+	};
+	TMap<int32, FTile> Tiles;
+	bool bHasTileEdges = false;
+	bool bHasOffMeshLinks = false;
+};
+
+/*
+ * Triangulated tiles kept by tile coordinate and data hash, so tiles that stream out and back in are appended without being gathered
+ * or triangulated again. Only the oldest tiles are forgotten once it is full.
+ */
+class FNavMeshRenderTileCache
+{
+public:
+	/*
+	* Forgets every tile if they were built with a different layout.
+	*/
+	void SetLayout(const FNavMeshRenderLayout& layout);
+	/*
+	* Forgets the oldest tiles until at most maxTiles are kept.
+	*/
+	void SetMaxTiles(int32 maxTiles);
+	/*
+	* Fills outTile without polys and outBuffers from the cache if the tile's data was triangulated before. The poly refs are moved to the tile's current ones.
+	* This reads Recast data and must be called on the game thread.
+	*/
+	bool FindTile(const ARecastNavMesh& navMesh, int32 tileIndex, FNavMeshRenderTileSnapshot& outTile, FNavMeshRenderTileBuffers& outBuffers) const;
+	void AddTile(const FNavMeshRenderTileSnapshot& tile, FNavMeshRenderTileBuffers&& buffers);
+	void Reset();
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	static uint64 GetKey(int32 tileX, int32 tileY, uint32 dataHash);
+
+	FNavMeshRenderLayout Layout;
+	TMap<uint64, FNavMeshRenderTileBuffers> Tiles;
+	/*
+	* Keys oldest first.
+	*/
+	TArray<uint64> KeyOrder;
+	int32 MaxTiles = 0;
+};
+
+namespace NavMeshRender
+{
+	/*
+	* Bumped whenever the built mesh data changes, so saved renders are rebuilt.
+	*/
+	constexpr uint32 MeshFormatVersion = 2;
+	uint32 PackArea(uint8 area, uint16 flags);
+	/*
+	* The vertex color every corner of a poly's triangles gets: R is the area ID, G the low and B the high byte of the poly flags, each divided by 255.
+	*/
+	FVector4f EncodeArea(uint32 packedArea);
+	/*
+	* Clears the mesh and enables the attributes the render mesh is built with.
+	* bPolyHighlights adds a second UV layer holding each triangle's highlight texel, see FNavMeshRenderLayout::GetHighlightTexel.
+	*/
+	void InitRenderMesh(UE::Geometry::FDynamicMesh3& mesh, bool bPolyHighlights = false);
+	/*
+	* Returns the chunk a tile belongs to. Everything is in chunk 0,0 when chunkSizeInTiles is 0.
+	*/
+	FIntPoint GetChunkCoord(const FNavMeshRenderTileSnapshot& tile, int32 chunkSizeInTiles);
+	FIntPoint GetChunkCoord(int32 tileX, int32 tileY, int32 chunkSizeInTiles);
+	/*
+	* Returns a value that changes whenever Recast replaces the tile, or 0 for an empty tile.
+	*/
+	uint64 GetTileSignature(const ARecastNavMesh& navMesh, int32 tileIndex);
+	/*
+	* The FNavMeshRenderLayout::HighlightTileStride the nav mesh's loaded tiles need: their largest poly count rounded up to a power of two, at least 16.
+	*/
+	int32 GetHighlightTileStride(const ARecastNavMesh& navMesh);
+	/*
+	* CRC of the tile's Recast data, or 0 for an empty tile. Unlike the signature this is stable across loads.
+	*/
+	uint32 GetTileDataHash(const ARecastNavMesh& navMesh, int32 tileIndex);
+	/*
+	* What a tile adds to a nav data hash. Nav data hashes are XORs of these, so tiles can be swapped in and out of one.
+	*/
+	uint32 GetTileHashContribution(int32 tileIndex, uint32 dataHash);
+	/*
+	* Order independent hash of every tile's Recast data.
+	*/
+	uint32 GetNavDataHash(const ARecastNavMesh& navMesh);
+	/*
+	* Nav data hash of the tiles a built mesh state was made from. Matches GetNavDataHash when the state covers every tile.
+	*/
+	uint32 GetNavDataHash(const FNavMeshRenderMeshState& state);
+	/*
+	* Copies the polys of a single tile out of the nav mesh. Polys already in finishedPolys are skipped.
+	* Detail triangles are only copied for ENavMeshRenderTriangulation::DetailMesh.
+	* This reads Recast data and must be called on the game thread.
+	*/
+	bool GatherTile(const ARecastNavMesh& navMesh, int32 tileIndex, ENavMeshRenderTriangulation triangulation, TSet<NavNodeRef>& finishedPolys, FNavMeshRenderTileSnapshot& outTile);
+	/*
+	* Copies the polys of every tile out of the nav mesh. Each poly is only copied once.
+	* This reads Recast data and must be called on the game thread.
+	*/
+	void GatherTiles(const ARecastNavMesh& navMesh, ENavMeshRenderTriangulation triangulation, TArray<FNavMeshRenderTileSnapshot>& outTiles);
+	/*
+	* Collects the outline edges of one tile from Recast's poly neighbor data. Edges without a neighbor, and portal edges whose neighboring tile
+	* is missing, are boundaries. With bTileEdges, edges shared with a neighboring tile are added too, but only by the lower tile index of the two
+	* that isTileDrawn accepts, so each shared edge is kept once. This reads Recast data and must be called on the game thread.
+	*/
+	void GatherTileOutline(const ARecastNavMesh& navMesh, int32 tileIndex, bool bTileEdges, bool bOffMeshLinks, TFunctionRef<bool(int32)> isTileDrawn, TArray<FNavMeshRenderEdge>& outEdges);
+	/*
+	* Moves the poly refs of buffers built from an earlier copy of the tile to the refs the tile has now.
+	* Detour gives a tile new refs every time it is attached, even if its data is unchanged.
+	*/
+	void RemapTilePolys(const ARecastNavMesh& navMesh, int32 tileIndex, FNavMeshRenderTileBuffers& buffers);
+	/*
+	* Copies the Recast detail mesh triangles of a poly, three verts each. Returns false if the poly has none.
+	*/
+	bool GetPolyDetailTriangles(const ARecastNavMesh& navMesh, NavNodeRef polyRef, TArray<FVector>& outTriangles);
+	/*
+	* Triangulates a tile snapshot into tile-local buffers.
+	*/
+	void BuildTile(const FNavMeshRenderLayout& layout, const FNavMeshRenderTileSnapshot& tile, FNavMeshRenderTileBuffers& outBuffers);
+	/*
+	* Copies a built tile into query data for FNavMeshRenderSpatialIndex.
+	*/
+	void BuildTileIndex(const FNavMeshRenderLayout& layout, const FNavMeshRenderTileSnapshot& tile, const FNavMeshRenderTileBuffers& buffers, FNavMeshRenderTileIndex& outIndex);
+	/*
+	* Triangulates the tile snapshots in parallel and keeps only their query data.
+	*/
+	void BuildTileIndices(const FNavMeshRenderLayout& layout, const TArray<FNavMeshRenderTileSnapshot>& tiles, TArray<FNavMeshRenderTileIndex>& outIndices);
+	/*
+	* Triangulates every tile snapshot in parallel. outBuffers matches the order of tiles.
+	*/
+	void BuildTiles(const FNavMeshRenderLayout& layout, const TArray<FNavMeshRenderTileSnapshot>& tiles, TArray<FNavMeshRenderTileBuffers>& outBuffers);
+	/*
+	* Builds a complete render mesh from tile snapshots. Safe to call from worker threads.
+	*/
+	void BuildMesh(const FNavMeshRenderLayout& layout, const TArray<FNavMeshRenderTileSnapshot>& tiles, UE::Geometry::FDynamicMesh3& outMesh, FNavMeshRenderMeshState& outState);
+	/*
+	* Builds one render mesh per chunk of chunkSizeInTiles x chunkSizeInTiles tiles. Chunks are ordered by their first tile.
+	* Safe to call from worker threads.
+	*/
+	void BuildChunks(const FNavMeshRenderLayout& layout, const TArray<FNavMeshRenderTileSnapshot>& tiles, int32 chunkSizeInTiles, TArray<FNavMeshRenderChunk>& outChunks);
+	/*
+	* Builds one render mesh per agent. The tiles of every agent are triangulated in a single parallel pass.
+	* The tile snapshots are freed once merged. Safe to call from worker threads.
+	*/
+	void BuildAgentMeshes(const FNavMeshRenderLayout& layout, TArray<FNavMeshRenderAgentBuild>& agentBuilds);
+	/*
+	* Removes the given tiles from a built mesh and appends the new snapshots in their place.
+	* tileBuffers matches tiles. Buffers that already have triangles, e.g. from FNavMeshRenderTileCache, are used as they are and the rest are triangulated.
+	* The query data of the new tiles is appended to outTileIndices.
+	*/
+	void RebuildTiles(const FNavMeshRenderLayout& layout, const TArray<int32>& dirtyTiles, const TArray<FNavMeshRenderTileSnapshot>& tiles, TArray<FNavMeshRenderTileBuffers>& tileBuffers,
+		UE::Geometry::FDynamicMesh3& mesh, FNavMeshRenderMeshState& state, TArray<FNavMeshRenderTileIndex>& outTileIndices);
+}
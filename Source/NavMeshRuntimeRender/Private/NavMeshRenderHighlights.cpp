@@ -0,0 +1,174 @@
+// Cutter H // 2024
+
+
+#include "NavMeshRenderHighlights.h"
+#include "NavMeshRenderBuilder.h"
+#include "NavMeshRenderLayout.h"
+
+#include "RHI.h"
+#include "NavMesh/RecastNavMesh.h"
+#if WITH_RECAST
+#include "Detour/DetourNavMesh.h"
+#endif
+
+namespace {
+	// Tile slots are added in steps of this many, so a few more tiles rarely recreate the texture.
+	constexpr int32 TileAlignment = 16;
+	const FIntPoint EmptySpan(MAX_int32, -1);
+}
+
+bool FNavMeshRenderHighlights::Update(const ARecastNavMesh& navMesh, const FNavMeshRenderLayout& layout) {
+#if WITH_RECAST
+	const dtNavMesh* detourMesh = navMesh.GetRecastMesh();
+	if (!detourMesh || layout.HighlightTileStride <= 0) {
+		return false;
+	}
+	int32 tileCount = 0;
+	for (int32 tileIndex = 0; tileIndex < detourMesh->getMaxTiles(); tileIndex++) {
+		const dtMeshTile* tile = detourMesh->getTile(tileIndex);
+		if (tile && tile->header) {
+			tileCount = tileIndex + 1;
+		}
+		// A replaced tile's polys reuse the old texels, so its highlights can't carry over.
+		if (TileSignatures.IsValidIndex(tileIndex) && TileSignatures[tileIndex] != 0 && TileSignatures[tileIndex] != NavMeshRender::GetTileSignature(navMesh, tileIndex)) {
+			ClearTile(tileIndex);
+		}
+	}
+	return Resize(layout.HighlightTileStride, FMath::Max(TileCount, Align(tileCount, TileAlignment)));
+#else
+	return false;
+#endif
+}
+
+bool FNavMeshRenderHighlights::SetPoly(const ARecastNavMesh& navMesh, const FNavMeshRenderLayout& layout, NavNodeRef polyRef, const FColor& color) {
+#if WITH_RECAST
+	const dtNavMesh* detourMesh = navMesh.GetRecastMesh();
+	const dtMeshTile* tile = nullptr;
+	const dtPoly* poly = nullptr;
+	if (!detourMesh || layout.HighlightTileStride <= 0 || dtStatusFailed(detourMesh->getTileAndPolyByRef((dtPolyRef)polyRef, &tile, &poly))) {
+		return false;
+	}
+	// The ref already holds the tile and poly index, so it addresses its texel directly.
+	const int32 polyIndex = (int32)detourMesh->decodePolyIdPoly((dtPolyRef)polyRef);
+	const int32 tileIndex = (int32)detourMesh->decodePolyIdTile((dtPolyRef)polyRef);
+	// A tile that outgrew the stride only gets its texels once the rebuild with the larger stride is applied.
+	if (polyIndex >= layout.HighlightTileStride) {
+		return false;
+	}
+	if (layout.HighlightTileStride != TileStride || tileIndex >= TileCount) {
+		Resize(layout.HighlightTileStride, FMath::Max(TileCount, Align(tileIndex + 1, TileAlignment)));
+	}
+	if (tileIndex >= TileCount) {
+		return false;
+	}
+	const uint64 signature = (uint64)detourMesh->getTileRef(tile);
+	if (TileSignatures[tileIndex] != signature) {
+		ClearTile(tileIndex);
+		TileSignatures[tileIndex] = signature;
+	}
+	SetTexel(tileIndex, polyIndex, color);
+	return true;
+#else
+	return false;
+#endif
+}
+
+void FNavMeshRenderHighlights::ClearAll() {
+	for (int32 tileIndex = 0; tileIndex < TileCount; tileIndex++) {
+		ClearTile(tileIndex);
+	}
+}
+
+void FNavMeshRenderHighlights::TakeDirtyRects(TArray<FIntRect>& outRects) {
+	outRects.Reset(DirtyRows.Num());
+	for (int32 y : DirtyRows) {
+		outRects.Add(FIntRect(DirtySpans[y].X, y, DirtySpans[y].Y + 1, y + 1));
+		DirtySpans[y] = EmptySpan;
+	}
+	DirtyRows.Reset();
+}
+
+void FNavMeshRenderHighlights::Reset() {
+	Size = FIntPoint::ZeroValue;
+	Texels.Empty();
+	TileStride = 0;
+	TileCount = 0;
+	TileSignatures.Empty();
+	LitSpans.Empty();
+	DirtySpans.Empty();
+	DirtyRows.Empty();
+}
+
+SIZE_T FNavMeshRenderHighlights::GetAllocatedSize() const {
+	return Texels.GetAllocatedSize() + TileSignatures.GetAllocatedSize() + LitSpans.GetAllocatedSize() + DirtySpans.GetAllocatedSize() + DirtyRows.GetAllocatedSize();
+}
+
+bool FNavMeshRenderHighlights::Resize(int32 tileStride, int32 tileCount) {
+	constexpr int32 width = FNavMeshRenderLayout::HighlightTextureWidth;
+	// Tile slots beyond the tallest texture the platform can make have no texels, so their polys can't be highlighted.
+	const int32 maxTileCount = (int32)FMath::Min<int64>((int64)GetMax2DTextureDimension() * width / tileStride, MAX_int32);
+	const bool bTooManyTiles = tileCount > maxTileCount;
+	tileCount = FMath::Min(tileCount, maxTileCount);
+	if (tileStride == TileStride && tileCount <= TileCount) {
+		return false;
+	}
+	if (bTooManyTiles) {
+		UE_LOG(LogNavigation, Error, TEXT("NavMeshRenderer can only highlight the polys of the first %d tiles, a %d texel tall highlight texture is the largest this platform supports."),
+			maxTileCount, GetMax2DTextureDimension());
+	}
+	const FIntPoint size(width, FMath::DivideAndRoundUp(tileCount * tileStride, width));
+	TArray<FColor> texels;
+	texels.SetNumZeroed(size.X * size.Y);
+	// Each tile's texels are one run, so they move over whole. A smaller stride cuts off polys the tiles no longer have.
+	const int32 keptPolys = FMath::Min(TileStride, tileStride);
+	for (int32 tileIndex = 0; tileIndex < FMath::Min(TileCount, tileCount); tileIndex++) {
+		if (TileSignatures[tileIndex] != 0) {
+			FMemory::Memcpy(&texels[tileIndex * tileStride], &Texels[tileIndex * TileStride], keptPolys * sizeof(FColor));
+		}
+		FIntPoint& litSpan = LitSpans[tileIndex];
+		litSpan.Y = FMath::Min(litSpan.Y, keptPolys - 1);
+	}
+	Texels = MoveTemp(texels);
+	Size = size;
+	TileStride = tileStride;
+	TileCount = tileCount;
+	TileSignatures.SetNumZeroed(TileCount);
+	while (LitSpans.Num() < TileCount) {
+		LitSpans.Add(EmptySpan);
+	}
+	LitSpans.SetNum(TileCount);
+	// Every texel may have moved, and a texture of the same size is only updated where it's dirty, so every row is.
+	DirtySpans.Init(FIntPoint(0, Size.X - 1), Size.Y);
+	DirtyRows.Reset(Size.Y);
+	for (int32 y = 0; y < Size.Y; y++) {
+		DirtyRows.Add(y);
+	}
+	return true;
+}
+
+void FNavMeshRenderHighlights::SetTexel(int32 tileIndex, int32 polyIndex, const FColor& color) {
+	const int32 texelIndex = tileIndex * TileStride + polyIndex;
+	FColor& texel = Texels[texelIndex];
+	if (texel == color) {
+		return;
+	}
+	texel = color;
+	FIntPoint& litSpan = LitSpans[tileIndex];
+	litSpan = FIntPoint(FMath::Min(litSpan.X, polyIndex), FMath::Max(litSpan.Y, polyIndex));
+	const int32 x = texelIndex % Size.X;
+	const int32 y = texelIndex / Size.X;
+	FIntPoint& dirtySpan = DirtySpans[y];
+	if (dirtySpan.X > dirtySpan.Y) {
+		DirtyRows.Add(y);
+	}
+	dirtySpan = FIntPoint(FMath::Min(dirtySpan.X, x), FMath::Max(dirtySpan.Y, x));
+}
+
+void FNavMeshRenderHighlights::ClearTile(int32 tileIndex) {
+	const FIntPoint litSpan = LitSpans[tileIndex];
+	for (int32 polyIndex = litSpan.X; polyIndex <= litSpan.Y; polyIndex++) {
+		SetTexel(tileIndex, polyIndex, FColor(0, 0, 0, 0));
+	}
+	LitSpans[tileIndex] = EmptySpan;
+	TileSignatures[tileIndex] = 0;
+}
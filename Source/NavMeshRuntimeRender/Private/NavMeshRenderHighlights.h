@@ -0,0 +1,82 @@
+// Cutter H // 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AI/Navigation/NavigationTypes.h"
+
+class ARecastNavMesh;
+struct FNavMeshRenderLayout;
+
+/*
+ * Highlight color of every nav poly, one texel each, laid out by FNavMeshRenderLayout::GetHighlightTexel: each tile slot gets a run of
+ * HighlightTileStride texels, wrapped into rows of HighlightTextureWidth. The render carries the same texel in its second UV layer,
+ * so a material finds a triangle's texel without any lookup, and changing a highlight only touches its texel.
+ * Writes are collected per row so only the changed spans are uploaded.
+ */
+class FNavMeshRenderHighlights
+{
+public:
+	/*
+	* Grows the texels to fit every loaded tile of the nav mesh, moves them over to the layout's stride if it changed,
+	* and clears the texels of tiles that were replaced since they were highlighted. Returns true if the texels were laid out again.
+	* This reads Recast data and must be called on the game thread.
+	*/
+	bool Update(const ARecastNavMesh& navMesh, const FNavMeshRenderLayout& layout);
+	/*
+	* Sets the texel of a poly. Returns false if the ref doesn't point at a poly the nav mesh currently has,
+	* or the poly has no texel in the layout or within the largest texture the platform supports.
+	* This reads Recast data and must be called on the game thread.
+	*/
+	bool SetPoly(const ARecastNavMesh& navMesh, const FNavMeshRenderLayout& layout, NavNodeRef polyRef, const FColor& color);
+	/*
+	* Clears every texel that was set since the last clear.
+	*/
+	void ClearAll();
+	/*
+	* Moves out the texel rect of every row span written since the last call.
+	*/
+	void TakeDirtyRects(TArray<FIntRect>& outRects);
+	void Reset();
+	bool IsEmpty() const {
+		return Texels.IsEmpty();
+	}
+	const TArray<FColor>& GetTexels() const {
+		return Texels;
+	}
+	FIntPoint GetSize() const {
+		return Size;
+	}
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	/*
+	* Makes room for the given tile slots at the given stride, keeping the texels of every highlighted tile. Slots past the largest texture
+	* the platform supports are dropped with an error. Marks every row dirty, since the texels may have moved without the size changing.
+	* Returns true if the texels were laid out again.
+	*/
+	bool Resize(int32 tileStride, int32 tileCount);
+	void SetTexel(int32 tileIndex, int32 polyIndex, const FColor& color);
+	void ClearTile(int32 tileIndex);
+
+	FIntPoint Size = FIntPoint::ZeroValue;
+	TArray<FColor> Texels;
+	/*
+	* Texels of each tile slot, and the number of tile slots the texels hold.
+	*/
+	int32 TileStride = 0;
+	int32 TileCount = 0;
+	/*
+	* Signature of the tile each slot was written for, or 0 for slots that hold nothing. See NavMeshRender::GetTileSignature.
+	*/
+	TArray<uint64> TileSignatures;
+	/*
+	* First and last poly of each tile slot that was written since the last clear. Slots without any have X above Y.
+	*/
+	TArray<FIntPoint> LitSpans;
+	/*
+	* First and last texel of each row that was written since the last upload. Rows without any have X above Y.
+	*/
+	TArray<FIntPoint> DirtySpans;
+	TArray<int32> DirtyRows;
+};
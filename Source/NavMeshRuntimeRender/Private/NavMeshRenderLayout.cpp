@@ -0,0 +1,183 @@
+// Cutter H // 2024
+
+
+#include "NavMeshRenderLayout.h"
+#include "Algo/BinarySearch.h"
+
+int FNavMeshRenderLayout::GetFloor(float centralHeight) const {
+	// The number of floor heights at or below the height.
+	return Algo::UpperBound(AdditionalFloorHeights, (float)(centralHeight - NavMeshCorner.Z));
+}
+
+FVector2f FNavMeshRenderLayout::UVCoord(const FVector& location, float centralHeight) const {
+	FVector2f retVal;
+	const FVector relativeLocation = location - NavMeshCorner;
+	const int floor = GetFloor(centralHeight);
+	if (!FloorUVTransforms.IsEmpty()) {
+		const FVector4 floorTransform = GetFloorUVTransform(floor);
+		return FVector2f(
+			relativeLocation.X * floorTransform.X + floorTransform.Z,
+			relativeLocation.Y * floorTransform.Y + floorTransform.W);
+	}
+	const float floorX = floor % FloorRowSize;
+	const float floorY = FMath::TruncToInt((float)floor / (float)FloorRowSize);
+	// retVal is not the correct uv position if the floor takes up the entire UV
+	retVal = FVector2f((relativeLocation.X / NavMeshSize.X) * (1 - UV_IslandMargins),
+		(relativeLocation.Y / NavMeshSize.Y) * (1 - UV_IslandMargins));
+	// positions retVal to accomodate multiple floors in the UV
+	if (NumberOfFloors > 1) {
+		retVal = FVector2f(
+			(retVal.X / (float)FloorRowSize) + (floorX / (float)FloorRowSize) + (floorX * UV_IslandMargins),
+			(retVal.Y / (float)FloorRowSize) + (floorY / (float)FloorRowSize) + (floorY * UV_IslandMargins)
+		);
+	}
+	return retVal;
+}
+
+void FNavMeshRenderLayout::UVCoords(TConstArrayView<FVector> locations, TConstArrayView<float> centralHeights, TArrayView<FVector2f> outUVs) const {
+	check(outUVs.Num() == locations.Num());
+	check(centralHeights.Num() == locations.Num() || centralHeights.IsEmpty());
+	const bool bUseLocationHeights = centralHeights.IsEmpty();
+	if (!FloorUVTransforms.IsEmpty()) {
+		for (int32 i = 0; i < locations.Num(); i++) {
+			const FVector& location = locations[i];
+			const FVector4& floorTransform = FloorUVTransforms[FMath::Min(GetFloor(bUseLocationHeights ? location.Z : centralHeights[i]), FloorUVTransforms.Num() - 1)];
+			outUVs[i] = FVector2f(
+				(location.X - NavMeshCorner.X) * floorTransform.X + floorTransform.Z,
+				(location.Y - NavMeshCorner.Y) * floorTransform.Y + floorTransform.W);
+		}
+		return;
+	}
+	// Same math as UVCoord, folded into one scale for every point and one offset per floor.
+	const bool bMultipleFloors = NumberOfFloors > 1;
+	const float rowScale = bMultipleFloors ? 1.f / (float)FloorRowSize : 1.f;
+	const FVector2f uvScale(
+		(1 - UV_IslandMargins) / NavMeshSize.X * rowScale,
+		(1 - UV_IslandMargins) / NavMeshSize.Y * rowScale);
+	TArray<FVector2f, TInlineAllocator<16>> floorOffsets;
+	floorOffsets.SetNumZeroed(AdditionalFloorHeights.Num() + 1);
+	if (bMultipleFloors) {
+		for (int floor = 0; floor < floorOffsets.Num(); floor++) {
+			const float floorX = floor % FloorRowSize;
+			const float floorY = FMath::TruncToInt((float)floor / (float)FloorRowSize);
+			floorOffsets[floor] = FVector2f(
+				(floorX / (float)FloorRowSize) + (floorX * UV_IslandMargins),
+				(floorY / (float)FloorRowSize) + (floorY * UV_IslandMargins));
+		}
+	}
+	for (int32 i = 0; i < locations.Num(); i++) {
+		const FVector& location = locations[i];
+		const int floor = GetFloor(bUseLocationHeights ? location.Z : centralHeights[i]);
+		outUVs[i] = FVector2f(
+			(location.X - NavMeshCorner.X) * uvScale.X,
+			(location.Y - NavMeshCorner.Y) * uvScale.Y) + floorOffsets[floor];
+	}
+}
+
+FVector4 FNavMeshRenderLayout::GetFloorUVTransform(int floor) const {
+	if (!FloorUVTransforms.IsEmpty()) {
+		return FloorUVTransforms[FMath::Clamp(floor, 0, FloorUVTransforms.Num() - 1)];
+	}
+	// The floor grid of UVCoord, folded into a scale and offset.
+	const bool bMultipleFloors = NumberOfFloors > 1;
+	const double rowScale = bMultipleFloors ? 1.0 / (double)FloorRowSize : 1.0;
+	FVector4 retVal(
+		(1 - UV_IslandMargins) / NavMeshSize.X * rowScale,
+		(1 - UV_IslandMargins) / NavMeshSize.Y * rowScale,
+		0.0, 0.0);
+	if (bMultipleFloors) {
+		const float floorX = floor % FloorRowSize;
+		const float floorY = FMath::TruncToInt((float)floor / (float)FloorRowSize);
+		retVal.Z = (floorX / (float)FloorRowSize) + (floorX * UV_IslandMargins);
+		retVal.W = (floorY / (float)FloorRowSize) + (floorY * UV_IslandMargins);
+	}
+	return retVal;
+}
+
+FBox FNavMeshRenderLayout::GetQuantizeGrid() const {
+	const FVector slack(1.0, 1.0, FMath::Abs(ZOffset) + 1.0);
+	return FBox(NavMeshCorner - slack, NavMeshCorner + NavMeshSize + slack);
+}
+
+FIntPoint FNavMeshRenderLayout::GetHighlightTexel(int32 tileIndex, int32 polyIndex) const {
+	const int64 texelIndex = (int64)tileIndex * HighlightTileStride + polyIndex;
+	return FIntPoint((int32)(texelIndex % HighlightTextureWidth), (int32)(texelIndex / HighlightTextureWidth));
+}
+
+void FNavMeshRenderLayout::PackFloors(TConstArrayView<FBox2D> floorBounds, float margin, TArray<FVector4>& outTransforms) {
+	outTransforms.Init(FVector4(0.0, 0.0, 0.0, 0.0), floorBounds.Num());
+	// Tallest first, so each shelf wastes little height.
+	TArray<int32> packOrder;
+	double largestSide = 0.0;
+	for (int32 floor = 0; floor < floorBounds.Num(); floor++) {
+		if (floorBounds[floor].bIsValid) {
+			packOrder.Add(floor);
+			largestSide = FMath::Max3(largestSide, floorBounds[floor].GetSize().X, floorBounds[floor].GetSize().Y);
+		}
+	}
+	if (packOrder.IsEmpty() || largestSide <= 0.0) {
+		return;
+	}
+	packOrder.Sort([&floorBounds](int32 a, int32 b) {
+		return floorBounds[a].GetSize().Y > floorBounds[b].GetSize().Y;
+	});
+	TArray<FVector2D> offsets;
+	offsets.SetNumZeroed(floorBounds.Num());
+	// Shelves left to right, top to bottom. Returns false if the floors don't fit at this scale.
+	auto shelfPack = [&floorBounds, &packOrder, &offsets, margin](double scale) {
+		double x = 0.0;
+		double y = 0.0;
+		double shelfHeight = 0.0;
+		for (int32 floor : packOrder) {
+			const FVector2D size = floorBounds[floor].GetSize() * scale;
+			if (x > 0.0 && x + size.X > 1.0) {
+				x = 0.0;
+				y += shelfHeight + margin;
+				shelfHeight = 0.0;
+			}
+			if (x + size.X > 1.0 || y + size.Y > 1.0) {
+				return false;
+			}
+			offsets[floor] = FVector2D(x, y);
+			x += size.X + margin;
+			shelfHeight = FMath::Max(shelfHeight, size.Y);
+		}
+		return true;
+	};
+	// One floor fills the square along its longer side, which is as large as any floor can be.
+	double fitScale = 0.0;
+	double tooLargeScale = 1.0 / largestSide;
+	if (shelfPack(tooLargeScale)) {
+		fitScale = tooLargeScale;
+	}
+	else {
+		for (int32 step = 0; step < 32; step++) {
+			const double scale = (fitScale + tooLargeScale) * 0.5;
+			if (shelfPack(scale)) {
+				fitScale = scale;
+			}
+			else {
+				tooLargeScale = scale;
+			}
+		}
+		shelfPack(fitScale);
+	}
+	for (int32 floor : packOrder) {
+		const FVector2D offset = offsets[floor] - floorBounds[floor].Min * fitScale;
+		outTransforms[floor] = FVector4(fitScale, fitScale, offset.X, offset.Y);
+	}
+}
+
+bool FNavMeshRenderLayout::operator==(const FNavMeshRenderLayout& other) const {
+	return NavMeshCorner == other.NavMeshCorner
+		&& NavMeshSize == other.NavMeshSize
+		&& AdditionalFloorHeights == other.AdditionalFloorHeights
+		&& UV_IslandMargins == other.UV_IslandMargins
+		&& ZOffset == other.ZOffset
+		&& NumberOfFloors == other.NumberOfFloors
+		&& FloorRowSize == other.FloorRowSize
+		&& FloorUVTransforms == other.FloorUVTransforms
+		&& Triangulation == other.Triangulation
+		&& bPolyHighlights == other.bPolyHighlights
+		&& HighlightTileStride == other.HighlightTileStride;
+}
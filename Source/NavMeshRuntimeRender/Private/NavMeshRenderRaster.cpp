@@ -0,0 +1,272 @@
+// Cutter H // 2024
+
+
+#include "NavMeshRenderRaster.h"
+#include "NavMeshRenderBuilder.h"
+#include "NavMeshRenderStats.h"
+
+#include "Algo/StableSort.h"
+#include "Async/ParallelFor.h"
+#include "NavMesh/RecastNavMesh.h"
+
+namespace {
+	// Bins are BinSize x BinSize texels. Each is rasterized by one task, so no two tasks write the same texel.
+	constexpr int32 BinSize = 64;
+	// Lets texel centers on a shared edge fall in either triangle, so there are no cracks between them.
+	constexpr float EdgeTolerance = 1e-4f;
+}
+
+void FNavMeshRenderRasterTile::Init(const FNavMeshRenderLayout& layout, const FIntPoint& size, uint64 signature, const FNavMeshRenderTileBuffers& buffers) {
+	Signature = signature;
+	Points.SetNumUninitialized(buffers.UVs.Num());
+	Heights.SetNumUninitialized(buffers.UVs.Num());
+	const double heightScale = 1.0 / FMath::Max(layout.NavMeshSize.Z, 1.0);
+	for (int32 i = 0; i < buffers.UVs.Num(); i++) {
+		Points[i] = FVector2f(buffers.UVs[i].X * size.X, buffers.UVs[i].Y * size.Y);
+		Heights[i] = (float)FMath::Clamp((buffers.Positions[i].Z - layout.ZOffset - layout.NavMeshCorner.Z) * heightScale, 0.0, 1.0);
+	}
+	// Ordered by floor so every floor is one contiguous part with its own bounds.
+	TArray<int32> triangleOrder;
+	triangleOrder.SetNumUninitialized(buffers.Triangles.Num());
+	for (int32 t = 0; t < triangleOrder.Num(); t++) {
+		triangleOrder[t] = t;
+	}
+	Algo::StableSortBy(triangleOrder, [&buffers](int32 t) {
+		return buffers.Floors[buffers.Triangles[t].A];
+	});
+	Triangles.Reset(triangleOrder.Num());
+	TriangleAreas.Reset(triangleOrder.Num());
+	Parts.Reset();
+	for (int32 t : triangleOrder) {
+		const UE::Geometry::FIndex3i& tri = buffers.Triangles[t];
+		const int32 floor = buffers.Floors[tri.A];
+		if (Parts.IsEmpty() || Parts.Last().Floor != floor) {
+			FFloorPart& newPart = Parts.AddDefaulted_GetRef();
+			newPart.Floor = floor;
+			newPart.FirstTriangle = Triangles.Num();
+		}
+		FFloorPart& part = Parts.Last();
+		part.NumTriangles++;
+		for (int32 k = 0; k < 3; k++) {
+			part.Bounds += Points[tri[k]];
+		}
+		Triangles.Add(tri);
+		TriangleAreas.Add((uint8)((buffers.TriangleAreas.IsValidIndex(t) ? buffers.TriangleAreas[t] : 0) & 0xFF));
+	}
+}
+
+SIZE_T FNavMeshRenderRasterTile::GetAllocatedSize() const {
+	return Points.GetAllocatedSize() + Heights.GetAllocatedSize() + Triangles.GetAllocatedSize() + TriangleAreas.GetAllocatedSize() + Parts.GetAllocatedSize();
+}
+
+bool FNavMeshRenderRaster::SetLayout(const FNavMeshRenderLayout& layout, const FIntPoint& size) {
+	if (!Texels.IsEmpty() && Layout == layout && Size == size) {
+		return false;
+	}
+	Layout = layout;
+	Size = FIntPoint(FMath::Max(size.X, 1), FMath::Max(size.Y, 1));
+	Tiles.Reset();
+	Texels.Init(FColor(0, 0, 0, 0), Size.X * Size.Y);
+	BinCount = FIntPoint(FMath::DivideAndRoundUp(Size.X, BinSize), FMath::DivideAndRoundUp(Size.Y, BinSize));
+	DirtyBins.Init(false, BinCount.X * BinCount.Y);
+	return true;
+}
+
+int32 FNavMeshRenderRaster::UpdateTiles(const ARecastNavMesh& navMesh) {
+	const int tileCount = navMesh.GetNavMeshTilesCount();
+	TSet<int32> changedTiles;
+	for (const TPair<int32, FNavMeshRenderRasterTile>& tile : Tiles) {
+		if (tile.Key >= tileCount || NavMeshRender::GetTileSignature(navMesh, tile.Key) != tile.Value.Signature) {
+			changedTiles.Add(tile.Key);
+		}
+	}
+	TArray<FNavMeshRenderTileSnapshot> gatheredTiles;
+	TSet<NavNodeRef> finishedPolys;
+	FNavMeshRenderTileSnapshot tile;
+	for (int32 v = 0; v < tileCount; v++) {
+		const uint64 signature = NavMeshRender::GetTileSignature(navMesh, v);
+		const FNavMeshRenderRasterTile* rasterTile = Tiles.Find(v);
+		if (signature == 0 || (rasterTile && rasterTile->Signature == signature)) {
+			continue;
+		}
+		changedTiles.Add(v);
+		if (NavMeshRender::GatherTile(navMesh, v, Layout.Triangulation, finishedPolys, tile)) {
+			gatheredTiles.Add(MoveTemp(tile));
+		}
+	}
+	// The bins the old triangles covered are rasterized again without them.
+	for (int32 tileIndex : changedTiles) {
+		if (const FNavMeshRenderRasterTile* rasterTile = Tiles.Find(tileIndex)) {
+			for (const FNavMeshRenderRasterTile::FFloorPart& part : rasterTile->Parts) {
+				MarkDirty(part.Bounds);
+			}
+		}
+		Tiles.Remove(tileIndex);
+	}
+	TArray<FNavMeshRenderTileBuffers> tileBuffers;
+	NavMeshRender::BuildTiles(Layout, gatheredTiles, tileBuffers);
+	TArray<FNavMeshRenderRasterTile> rasterTiles;
+	rasterTiles.SetNum(gatheredTiles.Num());
+	ParallelFor(gatheredTiles.Num(), [this, &gatheredTiles, &tileBuffers, &rasterTiles](int32 i) {
+		rasterTiles[i].Init(Layout, Size, gatheredTiles[i].Signature, tileBuffers[i]);
+	});
+	for (int32 i = 0; i < gatheredTiles.Num(); i++) {
+		for (const FNavMeshRenderRasterTile::FFloorPart& part : rasterTiles[i].Parts) {
+			MarkDirty(part.Bounds);
+		}
+		Tiles.Add(gatheredTiles[i].TileIndex, MoveTemp(rasterTiles[i]));
+	}
+	// Tiles without polys are remembered too, so they aren't gathered again until they change.
+	for (int32 tileIndex : changedTiles) {
+		if (!Tiles.Contains(tileIndex) && tileIndex < tileCount) {
+			const uint64 signature = NavMeshRender::GetTileSignature(navMesh, tileIndex);
+			if (signature != 0) {
+				Tiles.Add(tileIndex).Signature = signature;
+			}
+		}
+	}
+	return changedTiles.Num();
+}
+
+void FNavMeshRenderRaster::Rasterize(TArray<FIntRect>& outUpdatedRects) {
+	NAVMESHRENDER_SCOPE_CYCLE_COUNTER(STAT_NavMeshRender_Rasterize);
+	outUpdatedRects.Reset();
+	TArray<int32> dirtyBins;
+	TArray<int32> binSlots;
+	binSlots.Init(INDEX_NONE, DirtyBins.Num());
+	for (TConstSetBitIterator<> it(DirtyBins); it; ++it) {
+		binSlots[it.GetIndex()] = dirtyBins.Add(it.GetIndex());
+	}
+	if (dirtyBins.IsEmpty()) {
+		return;
+	}
+	// Bucket the floor parts by the dirty bins they overlap, so each bin only looks at its own triangles.
+	TArray<TArray<TPair<const FNavMeshRenderRasterTile*, int32>>> binParts;
+	binParts.SetNum(dirtyBins.Num());
+	for (const TPair<int32, FNavMeshRenderRasterTile>& tile : Tiles) {
+		for (int32 p = 0; p < tile.Value.Parts.Num(); p++) {
+			FIntPoint minBin;
+			FIntPoint maxBin;
+			if (!GetBinRange(tile.Value.Parts[p].Bounds, minBin, maxBin)) {
+				continue;
+			}
+			for (int32 y = minBin.Y; y <= maxBin.Y; y++) {
+				for (int32 x = minBin.X; x <= maxBin.X; x++) {
+					const int32 slot = binSlots[y * BinCount.X + x];
+					if (slot != INDEX_NONE) {
+						binParts[slot].Emplace(&tile.Value, p);
+					}
+				}
+			}
+		}
+	}
+	ParallelFor(dirtyBins.Num(), [this, &dirtyBins, &binParts](int32 i) {
+		RasterizeBin(dirtyBins[i], binParts[i]);
+	});
+	outUpdatedRects.Reserve(dirtyBins.Num());
+	for (int32 bin : dirtyBins) {
+		outUpdatedRects.Add(GetBinRect(bin));
+	}
+	DirtyBins.Init(false, DirtyBins.Num());
+}
+
+void FNavMeshRenderRaster::Reset() {
+	Layout = FNavMeshRenderLayout();
+	Size = FIntPoint::ZeroValue;
+	BinCount = FIntPoint::ZeroValue;
+	Texels.Empty();
+	Tiles.Empty();
+	DirtyBins.Empty();
+}
+
+SIZE_T FNavMeshRenderRaster::GetAllocatedSize() const {
+	SIZE_T retVal = Texels.GetAllocatedSize() + Tiles.GetAllocatedSize() + DirtyBins.GetAllocatedSize();
+	for (const TPair<int32, FNavMeshRenderRasterTile>& tile : Tiles) {
+		retVal += tile.Value.GetAllocatedSize();
+	}
+	return retVal;
+}
+
+void FNavMeshRenderRaster::MarkDirty(const FBox2f& texelBounds) {
+	FIntPoint minBin;
+	FIntPoint maxBin;
+	if (!GetBinRange(texelBounds, minBin, maxBin)) {
+		return;
+	}
+	for (int32 y = minBin.Y; y <= maxBin.Y; y++) {
+		for (int32 x = minBin.X; x <= maxBin.X; x++) {
+			DirtyBins[y * BinCount.X + x] = true;
+		}
+	}
+}
+
+bool FNavMeshRenderRaster::GetBinRange(const FBox2f& texelBounds, FIntPoint& outMin, FIntPoint& outMax) const {
+	if (!texelBounds.bIsValid || DirtyBins.IsEmpty()) {
+		return false;
+	}
+	outMin = FIntPoint(
+		FMath::Clamp(FMath::FloorToInt(texelBounds.Min.X) / BinSize, 0, BinCount.X - 1),
+		FMath::Clamp(FMath::FloorToInt(texelBounds.Min.Y) / BinSize, 0, BinCount.Y - 1));
+	outMax = FIntPoint(
+		FMath::Clamp(FMath::FloorToInt(texelBounds.Max.X) / BinSize, 0, BinCount.X - 1),
+		FMath::Clamp(FMath::FloorToInt(texelBounds.Max.Y) / BinSize, 0, BinCount.Y - 1));
+	return true;
+}
+
+FIntRect FNavMeshRenderRaster::GetBinRect(int32 bin) const {
+	const FIntPoint min((bin % BinCount.X) * BinSize, (bin / BinCount.X) * BinSize);
+	return FIntRect(min, FIntPoint(FMath::Min(min.X + BinSize, Size.X), FMath::Min(min.Y + BinSize, Size.Y)));
+}
+
+void FNavMeshRenderRaster::RasterizeBin(int32 bin, TConstArrayView<TPair<const FNavMeshRenderRasterTile*, int32>> binParts) {
+	const FIntRect rect = GetBinRect(bin);
+	for (int32 y = rect.Min.Y; y < rect.Max.Y; y++) {
+		FMemory::Memzero(&Texels[y * Size.X + rect.Min.X], rect.Width() * sizeof(FColor));
+	}
+	for (const TPair<const FNavMeshRenderRasterTile*, int32>& binPart : binParts) {
+		const FNavMeshRenderRasterTile::FFloorPart& part = binPart.Key->Parts[binPart.Value];
+		const uint8 floor = (uint8)FMath::Clamp(part.Floor, 0, 255);
+		for (int32 t = part.FirstTriangle; t < part.FirstTriangle + part.NumTriangles; t++) {
+			RasterizeTriangle(*binPart.Key, t, floor, rect);
+		}
+	}
+}
+
+void FNavMeshRenderRaster::RasterizeTriangle(const FNavMeshRenderRasterTile& tile, int32 triangle, uint8 floor, const FIntRect& rect) {
+	const UE::Geometry::FIndex3i& tri = tile.Triangles[triangle];
+	const FVector2f& a = tile.Points[tri.A];
+	const FVector2f& b = tile.Points[tri.B];
+	const FVector2f& c = tile.Points[tri.C];
+	const float area = (b.X - a.X) * (c.Y - a.Y) - (b.Y - a.Y) * (c.X - a.X);
+	if (FMath::Abs(area) < UE_KINDA_SMALL_NUMBER) {
+		return;
+	}
+	const int32 minX = FMath::Max(rect.Min.X, FMath::FloorToInt(FMath::Min3(a.X, b.X, c.X)));
+	const int32 minY = FMath::Max(rect.Min.Y, FMath::FloorToInt(FMath::Min3(a.Y, b.Y, c.Y)));
+	const int32 maxX = FMath::Min(rect.Max.X - 1, FMath::FloorToInt(FMath::Max3(a.X, b.X, c.X)));
+	const int32 maxY = FMath::Min(rect.Max.Y - 1, FMath::FloorToInt(FMath::Max3(a.Y, b.Y, c.Y)));
+	const float invArea = 1.f / area;
+	const float heightA = tile.Heights[tri.A];
+	const float heightB = tile.Heights[tri.B];
+	const float heightC = tile.Heights[tri.C];
+	const uint8 areaId = tile.TriangleAreas[triangle];
+	for (int32 y = minY; y <= maxY; y++) {
+		const float py = y + 0.5f;
+		for (int32 x = minX; x <= maxX; x++) {
+			const float px = x + 0.5f;
+			// Barycentrics of the texel center. Dividing by the signed area makes either winding work.
+			const float weightA = ((b.X - px) * (c.Y - py) - (b.Y - py) * (c.X - px)) * invArea;
+			const float weightB = ((c.X - px) * (a.Y - py) - (c.Y - py) * (a.X - px)) * invArea;
+			const float weightC = 1.f - weightA - weightB;
+			if (weightA < -EdgeTolerance || weightB < -EdgeTolerance || weightC < -EdgeTolerance) {
+				continue;
+			}
+			const uint8 height = (uint8)FMath::Clamp(FMath::RoundToInt((weightA * heightA + weightB * heightB + weightC * heightC) * 255.f), 0, 255);
+			FColor& texel = Texels[y * Size.X + x];
+			// Overlapping layers on one floor keep the highest, which is what a top down view shows.
+			if (texel.R == 0 || height >= texel.A) {
+				texel = FColor(255, floor, areaId, height);
+			}
+		}
+	}
+}
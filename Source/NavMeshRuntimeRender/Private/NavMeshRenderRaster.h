@@ -0,0 +1,94 @@
+// Cutter H // 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IndexTypes.h"
+#include "NavMeshRenderLayout.h"
+
+class ARecastNavMesh;
+struct FNavMeshRenderTileBuffers;
+
+/*
+ * The triangles of one nav tile in atlas texel space, grouped by floor so each group has tight bounds.
+ */
+struct FNavMeshRenderRasterTile
+{
+	/*
+	* Detour tile ref the triangles were made from. See NavMeshRender::GetTileSignature.
+	*/
+	uint64 Signature = 0;
+	TArray<FVector2f> Points;
+	/*
+	* Height of each point from 0 at the bottom of the nav bounds to 1 at the top.
+	*/
+	TArray<float> Heights;
+	TArray<UE::Geometry::FIndex3i> Triangles;
+	TArray<uint8> TriangleAreas;
+
+	struct FFloorPart
+	{
+		int32 Floor = 0;
+		FBox2f Bounds = FBox2f(ForceInit);
+		int32 FirstTriangle = 0;
+		int32 NumTriangles = 0;
+	};
+	TArray<FFloorPart> Parts;
+
+	/*
+	* Copies a triangulated tile into texel space. The layout's ZOffset is taken off the heights.
+	*/
+	void Init(const FNavMeshRenderLayout& layout, const FIntPoint& size, uint64 signature, const FNavMeshRenderTileBuffers& buffers);
+	SIZE_T GetAllocatedSize() const;
+};
+
+/*
+ * CPU rasterized copy of the render's floor atlas. Each texel holds coverage in R, the floor in G, the area ID in B and the height in A,
+ * at the UV the render gives that spot. Where layers overlap on one floor the highest wins.
+ * The atlas is split into bins that are rasterized in parallel, each by a single task, and only bins touched by changed tiles are redone.
+ */
+class FNavMeshRenderRaster
+{
+public:
+	/*
+	* Forgets every tile and clears the atlas if it was made with a different layout or size. Returns true if it did.
+	*/
+	bool SetLayout(const FNavMeshRenderLayout& layout, const FIntPoint& size);
+	/*
+	* Re-gathers and triangulates every tile whose signature changed since it was last rasterized, and drops tiles that are gone.
+	* Their bins are marked dirty. Returns the number of tiles that changed. This reads Recast data and must be called on the game thread.
+	*/
+	int32 UpdateTiles(const ARecastNavMesh& navMesh);
+	/*
+	* Clears and rasterizes every dirty bin. outUpdatedRects gets the texel rect of each.
+	*/
+	void Rasterize(TArray<FIntRect>& outUpdatedRects);
+	void Reset();
+	bool IsEmpty() const {
+		return Texels.IsEmpty();
+	}
+	const TArray<FColor>& GetTexels() const {
+		return Texels;
+	}
+	FIntPoint GetSize() const {
+		return Size;
+	}
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	void MarkDirty(const FBox2f& texelBounds);
+	/*
+	* The bins a texel space box overlaps, clamped to the atlas.
+	*/
+	bool GetBinRange(const FBox2f& texelBounds, FIntPoint& outMin, FIntPoint& outMax) const;
+	FIntRect GetBinRect(int32 bin) const;
+	void RasterizeBin(int32 bin, TConstArrayView<TPair<const FNavMeshRenderRasterTile*, int32>> binParts);
+	void RasterizeTriangle(const FNavMeshRenderRasterTile& tile, int32 triangle, uint8 floor, const FIntRect& rect);
+
+	FNavMeshRenderLayout Layout;
+	FIntPoint Size = FIntPoint::ZeroValue;
+	FIntPoint BinCount = FIntPoint::ZeroValue;
+	TArray<FColor> Texels;
+	TMap<int32, FNavMeshRenderRasterTile> Tiles;
+	TBitArray<> DirtyBins;
+};
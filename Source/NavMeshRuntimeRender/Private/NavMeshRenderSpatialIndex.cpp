@@ -0,0 +1,206 @@
+// Cutter H // 2024
+
+
+#include "NavMeshRenderSpatialIndex.h"
+#include "NavMeshRenderHit.h"
+
+namespace {
+	// Each tile is split into TileGridSize x TileGridSize cells.
+	constexpr int32 TileGridSize = 8;
+	// Lets points on a shared edge hit either triangle.
+	constexpr double BarycentricTolerance = 1e-4;
+}
+
+void FNavMeshRenderTileIndex::Init(int32 tileIndex, TConstArrayView<FVector> positions, TConstArrayView<FVector2f> uvs, TConstArrayView<int32> floors,
+	TConstArrayView<UE::Geometry::FIndex3i> triangles, TConstArrayView<NavNodeRef> trianglePolys, float zOffset) {
+	TileIndex = tileIndex;
+	Bounds = FBox2D(ForceInit);
+	Positions.Reset(positions.Num());
+	for (const FVector& position : positions) {
+		Positions.Add(FVector3f(position.X, position.Y, position.Z - zOffset));
+		Bounds += FVector2D(position.X, position.Y);
+	}
+	UVs.Reset();
+	UVs.Append(uvs.GetData(), uvs.Num());
+	Floors.Reset();
+	Floors.Append(floors.GetData(), floors.Num());
+	Triangles.Reset();
+	Triangles.Append(triangles.GetData(), triangles.Num());
+	TrianglePolys.Reset();
+	TrianglePolys.Append(trianglePolys.GetData(), trianglePolys.Num());
+
+	// Count, prefix sum, then fill, so the buckets are two flat arrays.
+	TArray<int32> cellCounts;
+	cellCounts.SetNumZeroed(TileGridSize * TileGridSize);
+	auto forEachCell = [this](const UE::Geometry::FIndex3i& tri, auto&& callback) {
+		FBox2D triBounds(ForceInit);
+		for (int32 k = 0; k < 3; k++) {
+			triBounds += FVector2D(Positions[tri[k]].X, Positions[tri[k]].Y);
+		}
+		const FIntPoint minCell = GetCellCoord(triBounds.Min);
+		const FIntPoint maxCell = GetCellCoord(triBounds.Max);
+		for (int32 y = minCell.Y; y <= maxCell.Y; y++) {
+			for (int32 x = minCell.X; x <= maxCell.X; x++) {
+				callback(y * TileGridSize + x);
+			}
+		}
+	};
+	for (const UE::Geometry::FIndex3i& tri : Triangles) {
+		forEachCell(tri, [&cellCounts](int32 cell) {
+			cellCounts[cell]++;
+		});
+	}
+	CellStarts.SetNumUninitialized(cellCounts.Num() + 1);
+	CellStarts[0] = 0;
+	for (int32 cell = 0; cell < cellCounts.Num(); cell++) {
+		CellStarts[cell + 1] = CellStarts[cell] + cellCounts[cell];
+	}
+	CellTriangles.SetNumUninitialized(CellStarts.Last());
+	TArray<int32> cellFill(CellStarts.GetData(), cellCounts.Num());
+	for (int32 t = 0; t < Triangles.Num(); t++) {
+		forEachCell(Triangles[t], [this, &cellFill, t](int32 cell) {
+			CellTriangles[cellFill[cell]++] = t;
+		});
+	}
+}
+
+void FNavMeshRenderTileIndex::FindHit(const FVector& location, float& inOutMaxHeightDelta, FNavMeshRenderHit& outHit) const {
+	const FVector2D point(location.X, location.Y);
+	if (!Bounds.IsInsideOrOn(point)) {
+		return;
+	}
+	const int32 cell = GetCell(point);
+	for (int32 c = CellStarts[cell]; c < CellStarts[cell + 1]; c++) {
+		const int32 t = CellTriangles[c];
+		const UE::Geometry::FIndex3i& tri = Triangles[t];
+		const FVector3f& a = Positions[tri.A];
+		const FVector3f& b = Positions[tri.B];
+		const FVector3f& c0 = Positions[tri.C];
+		// Barycentrics in XY, the render is a height field within a tile layer.
+		const FVector2D v0(b.X - a.X, b.Y - a.Y);
+		const FVector2D v1(c0.X - a.X, c0.Y - a.Y);
+		const FVector2D v2(point.X - a.X, point.Y - a.Y);
+		const double denominator = v0.X * v1.Y - v1.X * v0.Y;
+		if (FMath::Abs(denominator) < UE_SMALL_NUMBER) {
+			continue;
+		}
+		const double v = (v2.X * v1.Y - v1.X * v2.Y) / denominator;
+		const double w = (v0.X * v2.Y - v2.X * v0.Y) / denominator;
+		const double u = 1.0 - v - w;
+		if (u < -BarycentricTolerance || v < -BarycentricTolerance || w < -BarycentricTolerance) {
+			continue;
+		}
+		const double height = u * a.Z + v * b.Z + w * c0.Z;
+		const float heightDelta = (float)FMath::Abs(height - location.Z);
+		if (heightDelta > inOutMaxHeightDelta) {
+			continue;
+		}
+		inOutMaxHeightDelta = heightDelta;
+		const FVector2f uv = UVs[tri.A] * (float)u + UVs[tri.B] * (float)v + UVs[tri.C] * (float)w;
+		outHit.bHit = true;
+		outHit.PolyRef = (int64)TrianglePolys[t];
+		outHit.TileIndex = TileIndex;
+		outHit.TileTriangleIndex = t;
+		outHit.Barycentric = FVector(u, v, w);
+		outHit.Location = FVector(point.X, point.Y, height);
+		outHit.UV = FVector2D(uv.X, uv.Y);
+		outHit.Floor = Floors[tri.A];
+	}
+}
+
+SIZE_T FNavMeshRenderTileIndex::GetAllocatedSize() const {
+	return Positions.GetAllocatedSize() + UVs.GetAllocatedSize() + Floors.GetAllocatedSize() + Triangles.GetAllocatedSize()
+		+ TrianglePolys.GetAllocatedSize() + CellStarts.GetAllocatedSize() + CellTriangles.GetAllocatedSize();
+}
+
+int32 FNavMeshRenderTileIndex::GetCell(const FVector2D& location) const {
+	const FIntPoint cellCoord = GetCellCoord(location);
+	return cellCoord.Y * TileGridSize + cellCoord.X;
+}
+
+FIntPoint FNavMeshRenderTileIndex::GetCellCoord(const FVector2D& location) const {
+	const FVector2D size = Bounds.GetSize();
+	const FVector2D relative = location - Bounds.Min;
+	return FIntPoint(
+		size.X > 0 ? FMath::Clamp(FMath::FloorToInt(relative.X / size.X * TileGridSize), 0, TileGridSize - 1) : 0,
+		size.Y > 0 ? FMath::Clamp(FMath::FloorToInt(relative.Y / size.Y * TileGridSize), 0, TileGridSize - 1) : 0);
+}
+
+void FNavMeshRenderSpatialIndex::Reset() {
+	Tiles.Reset();
+	TilesByCell.Reset();
+	CellSize = 0.0;
+	bComplete = false;
+}
+
+void FNavMeshRenderSpatialIndex::AddTile(FNavMeshRenderTileIndex&& tile) {
+	RemoveTile(tile.TileIndex);
+	if (!tile.Bounds.bIsValid) {
+		return;
+	}
+	if (Tiles.IsEmpty()) {
+		CellSize = FMath::Max(tile.Bounds.GetSize().GetMax(), 1.0);
+	}
+	const int32 tileIndex = tile.TileIndex;
+	const FIntPoint minCell = GetCell(tile.Bounds.Min);
+	const FIntPoint maxCell = GetCell(tile.Bounds.Max);
+	for (int32 y = minCell.Y; y <= maxCell.Y; y++) {
+		for (int32 x = minCell.X; x <= maxCell.X; x++) {
+			TilesByCell.FindOrAdd(FIntPoint(x, y)).Add(tileIndex);
+		}
+	}
+	Tiles.Add(tileIndex, MoveTemp(tile));
+}
+
+void FNavMeshRenderSpatialIndex::RemoveTile(int32 tileIndex) {
+	const FNavMeshRenderTileIndex* tile = Tiles.Find(tileIndex);
+	if (!tile) {
+		return;
+	}
+	const FIntPoint minCell = GetCell(tile->Bounds.Min);
+	const FIntPoint maxCell = GetCell(tile->Bounds.Max);
+	Tiles.Remove(tileIndex);
+	for (int32 y = minCell.Y; y <= maxCell.Y; y++) {
+		for (int32 x = minCell.X; x <= maxCell.X; x++) {
+			if (TArray<int32>* cellTiles = TilesByCell.Find(FIntPoint(x, y))) {
+				cellTiles->RemoveSwap(tileIndex);
+				if (cellTiles->IsEmpty()) {
+					TilesByCell.Remove(FIntPoint(x, y));
+				}
+			}
+		}
+	}
+}
+
+bool FNavMeshRenderSpatialIndex::FindHit(const FVector& location, float maxHeightDelta, FNavMeshRenderHit& outHit) const {
+	outHit = FNavMeshRenderHit();
+	if (CellSize <= 0.0) {
+		return false;
+	}
+	const TArray<int32>* cellTiles = TilesByCell.Find(GetCell(FVector2D(location.X, location.Y)));
+	if (!cellTiles) {
+		return false;
+	}
+	float bestHeightDelta = maxHeightDelta;
+	for (int32 tileIndex : *cellTiles) {
+		if (const FNavMeshRenderTileIndex* tile = Tiles.Find(tileIndex)) {
+			tile->FindHit(location, bestHeightDelta, outHit);
+		}
+	}
+	return outHit.bHit;
+}
+
+SIZE_T FNavMeshRenderSpatialIndex::GetAllocatedSize() const {
+	SIZE_T retVal = Tiles.GetAllocatedSize() + TilesByCell.GetAllocatedSize();
+	for (const TPair<int32, FNavMeshRenderTileIndex>& tile : Tiles) {
+		retVal += tile.Value.GetAllocatedSize();
+	}
+	for (const TPair<FIntPoint, TArray<int32>>& cellTiles : TilesByCell) {
+		retVal += cellTiles.Value.GetAllocatedSize();
+	}
+	return retVal;
+}
+
+FIntPoint FNavMeshRenderSpatialIndex::GetCell(const FVector2D& location) const {
+	return FIntPoint(FMath::FloorToInt(location.X / CellSize), FMath::FloorToInt(location.Y / CellSize));
+}
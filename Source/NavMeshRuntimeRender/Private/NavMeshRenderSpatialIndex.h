@@ -0,0 +1,84 @@
+// Cutter H // 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "IndexTypes.h"
+
+struct FNavMeshRenderHit;
+
+/*
+ * The rendered triangles of one nav tile, bucketed into a small XY grid for point queries.
+ */
+struct FNavMeshRenderTileIndex
+{
+	int32 TileIndex = INDEX_NONE;
+	FBox2D Bounds = FBox2D(ForceInit);
+	TArray<FVector3f> Positions;
+	TArray<FVector2f> UVs;
+	TArray<int32> Floors;
+	TArray<UE::Geometry::FIndex3i> Triangles;
+	TArray<NavNodeRef> TrianglePolys;
+	/*
+	* Triangles of each grid cell are CellTriangles[CellStarts[cell]] up to CellTriangles[CellStarts[cell + 1]].
+	*/
+	TArray<int32> CellStarts;
+	TArray<int32> CellTriangles;
+
+	/*
+	* Copies the tile's triangles and buckets them. zOffset is taken off the positions so hits are in nav space.
+	*/
+	void Init(int32 tileIndex, TConstArrayView<FVector> positions, TConstArrayView<FVector2f> uvs, TConstArrayView<int32> floors,
+		TConstArrayView<UE::Geometry::FIndex3i> triangles, TConstArrayView<NavNodeRef> trianglePolys, float zOffset);
+	/*
+	* Replaces outHit if a triangle under the location is closer in height than inOutMaxHeightDelta, which is lowered to match.
+	*/
+	void FindHit(const FVector& location, float& inOutMaxHeightDelta, FNavMeshRenderHit& outHit) const;
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	int32 GetCell(const FVector2D& location) const;
+	FIntPoint GetCellCoord(const FVector2D& location) const;
+};
+
+/*
+ * Finds the rendered triangle and nav poly under a location without tracing against the render.
+ * Tiles are bucketed into a coarse XY grid and each tile buckets its own triangles, so tiles can be swapped individually.
+ * Read-only queries are safe from several threads at once.
+ */
+class FNavMeshRenderSpatialIndex
+{
+public:
+	void Reset();
+	/*
+	* Adds a tile, replacing any tile with the same index.
+	*/
+	void AddTile(FNavMeshRenderTileIndex&& tile);
+	void RemoveTile(int32 tileIndex);
+	/*
+	* Finds the triangle under the location whose height is closest to the location's, within maxHeightDelta.
+	*/
+	bool FindHit(const FVector& location, float maxHeightDelta, FNavMeshRenderHit& outHit) const;
+	/*
+	* Set once every rendered tile is in the index. Incomplete indices are rebuilt before being queried.
+	*/
+	bool IsComplete() const {
+		return bComplete;
+	}
+	void MarkComplete() {
+		bComplete = true;
+	}
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	FIntPoint GetCell(const FVector2D& location) const;
+
+	TMap<int32, FNavMeshRenderTileIndex> Tiles;
+	TMap<FIntPoint, TArray<int32>> TilesByCell;
+	/*
+	* Taken from the first tile added, so a cell is roughly one nav tile.
+	*/
+	double CellSize = 0.0;
+	bool bComplete = false;
+};
@@ -0,0 +1,35 @@
+// Cutter H // 2024
+
+
+#include "NavMeshRenderStats.h"
+
+DEFINE_STAT(STAT_NavMeshRender_UpdateMesh);
+DEFINE_STAT(STAT_NavMeshRender_UpdateChangedTiles);
+DEFINE_STAT(STAT_NavMeshRender_TimeSlicedUpdate);
+DEFINE_STAT(STAT_NavMeshRender_GatherTile);
+DEFINE_STAT(STAT_NavMeshRender_BuildTiles);
+DEFINE_STAT(STAT_NavMeshRender_BuildTile);
+DEFINE_STAT(STAT_NavMeshRender_AppendTile);
+DEFINE_STAT(STAT_NavMeshRender_RemoveTile);
+DEFINE_STAT(STAT_NavMeshRender_BuildTileIndex);
+DEFINE_STAT(STAT_NavMeshRender_ApplyChunks);
+DEFINE_STAT(STAT_NavMeshRender_CompactMesh);
+DEFINE_STAT(STAT_NavMeshRender_RebuildSpatialIndex);
+DEFINE_STAT(STAT_NavMeshRender_FindRenderHits);
+DEFINE_STAT(STAT_NavMeshRender_UVCoords);
+DEFINE_STAT(STAT_NavMeshRender_DrawFloors);
+DEFINE_STAT(STAT_NavMeshRender_UpdateStreaming);
+DEFINE_STAT(STAT_NavMeshRender_Rasterize);
+DEFINE_STAT(STAT_NavMeshRender_SetPolyHighlights);
+
+DEFINE_STAT(STAT_NavMeshRender_VerticesAppended);
+DEFINE_STAT(STAT_NavMeshRender_TrianglesAppended);
+DEFINE_STAT(STAT_NavMeshRender_RenderStatesDirtied);
+DEFINE_STAT(STAT_NavMeshRender_ChunksStreamedIn);
+DEFINE_STAT(STAT_NavMeshRender_ChunksStreamedOut);
+
+DEFINE_STAT(STAT_NavMeshRender_DynamicMeshMemory);
+DEFINE_STAT(STAT_NavMeshRender_CompactMeshMemory);
+DEFINE_STAT(STAT_NavMeshRender_SpatialIndexMemory);
+DEFINE_STAT(STAT_NavMeshRender_TileCacheMemory);
+DEFINE_STAT(STAT_NavMeshRender_RasterMemory);
@@ -0,0 +1,52 @@
+// Cutter H // 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+/*
+ * Shown with "stat NavMeshRender".
+ */
+DECLARE_STATS_GROUP(TEXT("NavMeshRender"), STATGROUP_NavMeshRender, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update Mesh"), STAT_NavMeshRender_UpdateMesh, STATGROUP_NavMeshRender, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update Changed Tiles"), STAT_NavMeshRender_UpdateChangedTiles, STATGROUP_NavMeshRender, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Time Sliced Update"), STAT_NavMeshRender_TimeSlicedUpdate, STATGROUP_NavMeshRender, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Gather Tile"), STAT_NavMeshRender_GatherTile, STATGROUP_NavMeshRender, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Triangulate Tiles"), STAT_NavMeshRender_BuildTiles, STATGROUP_NavMeshRender, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Triangulate Tile"), STAT_NavMeshRender_BuildTile, STATGROUP_NavMeshRender, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Append Tile"), STAT_NavMeshRender_AppendTile, STATGROUP_NavMeshRender, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Remove Tile"), STAT_NavMeshRender_RemoveTile, STATGROUP_NavMeshRender, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Build Tile Index"), STAT_NavMeshRender_BuildTileIndex, STATGROUP_NavMeshRender, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Apply Chunks"), STAT_NavMeshRender_ApplyChunks, STATGROUP_NavMeshRender, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Compact Mesh"), STAT_NavMeshRender_CompactMesh, STATGROUP_NavMeshRender, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Rebuild Spatial Index"), STAT_NavMeshRender_RebuildSpatialIndex, STATGROUP_NavMeshRender, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Render Hits"), STAT_NavMeshRender_FindRenderHits, STATGROUP_NavMeshRender, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("UV Coordinates"), STAT_NavMeshRender_UVCoords, STATGROUP_NavMeshRender, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Draw Floors"), STAT_NavMeshRender_DrawFloors, STATGROUP_NavMeshRender, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update Streaming"), STAT_NavMeshRender_UpdateStreaming, STATGROUP_NavMeshRender, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Rasterize Atlas"), STAT_NavMeshRender_Rasterize, STATGROUP_NavMeshRender, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Set Poly Highlights"), STAT_NavMeshRender_SetPolyHighlights, STATGROUP_NavMeshRender, );
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Vertices Appended"), STAT_NavMeshRender_VerticesAppended, STATGROUP_NavMeshRender, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Triangles Appended"), STAT_NavMeshRender_TrianglesAppended, STATGROUP_NavMeshRender, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Render States Dirtied"), STAT_NavMeshRender_RenderStatesDirtied, STATGROUP_NavMeshRender, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Chunks Streamed In"), STAT_NavMeshRender_ChunksStreamedIn, STATGROUP_NavMeshRender, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Chunks Streamed Out"), STAT_NavMeshRender_ChunksStreamedOut, STATGROUP_NavMeshRender, );
+
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Dynamic Mesh Memory"), STAT_NavMeshRender_DynamicMeshMemory, STATGROUP_NavMeshRender, );
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Compact Mesh Memory"), STAT_NavMeshRender_CompactMeshMemory, STATGROUP_NavMeshRender, );
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Spatial Index Memory"), STAT_NavMeshRender_SpatialIndexMemory, STATGROUP_NavMeshRender, );
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Tile Cache Memory"), STAT_NavMeshRender_TileCacheMemory, STATGROUP_NavMeshRender, );
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Raster Memory"), STAT_NavMeshRender_RasterMemory, STATGROUP_NavMeshRender, );
+
+/*
+ * Stats are compiled out of Test builds but CPU trace scopes are not, so the scopes still show up in Insights there.
+ */
+#if STATS
+#define NAVMESHRENDER_SCOPE_CYCLE_COUNTER(Stat) SCOPE_CYCLE_COUNTER(Stat)
+#else
+#define NAVMESHRENDER_SCOPE_CYCLE_COUNTER(Stat) TRACE_CPUPROFILER_EVENT_SCOPE(Stat)
+#endif
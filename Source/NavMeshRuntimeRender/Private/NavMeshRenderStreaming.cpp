@@ -0,0 +1,107 @@
+// Cutter H // 2024
+
+
+#include "NavMeshRenderStreaming.h"
+#include "NavMeshRenderBuilder.h"
+#include "NavMesh/RecastNavMesh.h"
+
+void FNavMeshRenderStreaming::RefreshTiles(const ARecastNavMesh& navMesh, int32 chunkSizeInTiles) {
+	ChunkSizeInTiles = FMath::Max(chunkSizeInTiles, 1);
+	TMap<FIntPoint, FNavMeshRenderStreamingChunk> oldChunks = MoveTemp(Chunks);
+	Chunks.Reset();
+	const int tileCount = navMesh.GetNavMeshTilesCount();
+	for (int32 tileIndex = 0; tileIndex < tileCount; tileIndex++) {
+		int32 tileX = 0;
+		int32 tileY = 0;
+		int32 tileLayer = 0;
+		// Empty tile slots have no coordinate.
+		if (!navMesh.GetNavMeshTileXY(tileIndex, tileX, tileY, tileLayer)) {
+			continue;
+		}
+		FNavMeshRenderStreamingChunk& chunk = Chunks.FindOrAdd(NavMeshRender::GetChunkCoord(tileX, tileY, ChunkSizeInTiles));
+		chunk.Tiles.Add(tileIndex);
+		const FBox tileBounds = navMesh.GetNavMeshTileBounds(tileIndex);
+		if (tileBounds.IsValid) {
+			chunk.Bounds += FBox2D(FVector2D(tileBounds.Min), FVector2D(tileBounds.Max));
+		}
+	}
+	for (TPair<FIntPoint, FNavMeshRenderStreamingChunk>& oldChunk : oldChunks) {
+		if (!oldChunk.Value.bLoaded) {
+			continue;
+		}
+		// A chunk that lost all its tiles is kept until its empty rebuild unloads it.
+		FNavMeshRenderStreamingChunk& chunk = Chunks.FindOrAdd(oldChunk.Key);
+		chunk.bLoaded = true;
+		chunk.bStale = oldChunk.Value.bStale || chunk.Tiles != oldChunk.Value.Tiles;
+		if (!chunk.Bounds.bIsValid) {
+			chunk.Bounds = oldChunk.Value.Bounds;
+		}
+	}
+	bInitialized = true;
+}
+
+void FNavMeshRenderStreaming::GetChunksToLoad(TConstArrayView<FVector> viewers, float loadRadius, TArray<FIntPoint>& outChunks) const {
+	outChunks.Reset();
+	const double loadRadiusSquared = FMath::Square((double)loadRadius);
+	TArray<TPair<double, FIntPoint>> candidates;
+	for (const TPair<FIntPoint, FNavMeshRenderStreamingChunk>& chunk : Chunks) {
+		if (chunk.Value.BuildSerial != 0 || (chunk.Value.bLoaded && !chunk.Value.bStale) || (!chunk.Value.bLoaded && chunk.Value.Tiles.IsEmpty())) {
+			continue;
+		}
+		const double distanceSquared = GetDistanceSquared(chunk.Value, viewers);
+		// Stale chunks are on screen, so they are refreshed wherever they are. Far ones are unloaded before this.
+		if (distanceSquared <= loadRadiusSquared || chunk.Value.bLoaded) {
+			candidates.Emplace(distanceSquared, chunk.Key);
+		}
+	}
+	candidates.Sort([](const TPair<double, FIntPoint>& a, const TPair<double, FIntPoint>& b) {
+		return a.Key < b.Key;
+	});
+	outChunks.Reserve(candidates.Num());
+	for (const TPair<double, FIntPoint>& candidate : candidates) {
+		outChunks.Add(candidate.Value);
+	}
+}
+
+void FNavMeshRenderStreaming::GetChunksToUnload(TConstArrayView<FVector> viewers, float unloadRadius, TArray<FIntPoint>& outChunks) const {
+	outChunks.Reset();
+	const double unloadRadiusSquared = FMath::Square((double)unloadRadius);
+	for (const TPair<FIntPoint, FNavMeshRenderStreamingChunk>& chunk : Chunks) {
+		if ((chunk.Value.bLoaded || chunk.Value.BuildSerial != 0) && GetDistanceSquared(chunk.Value, viewers) > unloadRadiusSquared) {
+			outChunks.Add(chunk.Key);
+		}
+	}
+}
+
+void FNavMeshRenderStreaming::MarkUnloaded(const FIntPoint& chunkCoord) {
+	if (FNavMeshRenderStreamingChunk* chunk = Chunks.Find(chunkCoord)) {
+		chunk->bLoaded = false;
+		chunk->bStale = false;
+		chunk->BuildSerial = 0;
+	}
+}
+
+FNavMeshRenderStreamingChunk* FNavMeshRenderStreaming::FindChunk(const FIntPoint& chunkCoord) {
+	return Chunks.Find(chunkCoord);
+}
+
+int32 FNavMeshRenderStreaming::GetNumBuilding() const {
+	int32 retVal = 0;
+	for (const TPair<FIntPoint, FNavMeshRenderStreamingChunk>& chunk : Chunks) {
+		if (chunk.Value.BuildSerial != 0) {
+			retVal++;
+		}
+	}
+	return retVal;
+}
+
+double FNavMeshRenderStreaming::GetDistanceSquared(const FNavMeshRenderStreamingChunk& chunk, TConstArrayView<FVector> viewers) {
+	double retVal = TNumericLimits<double>::Max();
+	if (!chunk.Bounds.bIsValid) {
+		return retVal;
+	}
+	for (const FVector& viewer : viewers) {
+		retVal = FMath::Min(retVal, chunk.Bounds.ComputeSquaredDistanceToPoint(FVector2D(viewer.X, viewer.Y)));
+	}
+	return retVal;
+}
@@ -0,0 +1,75 @@
+// Cutter H // 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class ARecastNavMesh;
+
+/*
+ * A square of nav tiles that is streamed in and out as a whole.
+ */
+struct FNavMeshRenderStreamingChunk
+{
+	TArray<int32> Tiles;
+	/*
+	* XY bounds of the chunk's tiles. Distances to viewers are measured to this.
+	*/
+	FBox2D Bounds = FBox2D(ForceInit);
+	/*
+	* Serial of the build running for this chunk, 0 when none is. Results that don't match are discarded.
+	*/
+	uint32 BuildSerial = 0;
+	bool bLoaded = false;
+	/*
+	* Set when the tiles of a loaded chunk changed, so it is built again while the old render stays up.
+	*/
+	bool bStale = false;
+};
+
+/*
+ * Tracks which chunks of the nav mesh are within reach of the viewers and which of them are loaded or building.
+ * Only tile coordinates and bounds are read, never polys, so this stays cheap on very large nav meshes.
+ */
+class FNavMeshRenderStreaming
+{
+public:
+	/*
+	* Assigns every nav tile to its chunk. Chunks that were loaded or building keep that state.
+	* Loaded chunks whose tiles changed are marked stale, and running builds are dropped since they may have copied old tile data.
+	*/
+	void RefreshTiles(const ARecastNavMesh& navMesh, int32 chunkSizeInTiles);
+	/*
+	* Chunks to build, nearest first: unloaded chunks within loadRadius of a viewer, and stale loaded chunks.
+	*/
+	void GetChunksToLoad(TConstArrayView<FVector> viewers, float loadRadius, TArray<FIntPoint>& outChunks) const;
+	/*
+	* Loaded or building chunks further than unloadRadius from every viewer.
+	*/
+	void GetChunksToUnload(TConstArrayView<FVector> viewers, float unloadRadius, TArray<FIntPoint>& outChunks) const;
+	/*
+	* Forgets the chunk's render and any build running for it.
+	*/
+	void MarkUnloaded(const FIntPoint& chunkCoord);
+	FNavMeshRenderStreamingChunk* FindChunk(const FIntPoint& chunkCoord);
+	int32 GetNumBuilding() const;
+	int32 GetChunkSizeInTiles() const {
+		return ChunkSizeInTiles;
+	}
+	/*
+	* Set once RefreshTiles has run.
+	*/
+	bool IsInitialized() const {
+		return bInitialized;
+	}
+
+private:
+	/*
+	* Squared XY distance from the chunk to the closest viewer.
+	*/
+	static double GetDistanceSquared(const FNavMeshRenderStreamingChunk& chunk, TConstArrayView<FVector> viewers);
+
+	TMap<FIntPoint, FNavMeshRenderStreamingChunk> Chunks;
+	int32 ChunkSizeInTiles = 1;
+	bool bInitialized = false;
+};
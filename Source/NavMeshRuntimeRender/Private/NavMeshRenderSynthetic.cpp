@@ -0,0 +1,177 @@
+// Cutter H // 2024
+
+
+#include "NavMeshRenderSynthetic.h"
+#include "NavMeshRenderBuilder.h"
+
+#include "NavMesh/RecastNavMesh.h"
+#if WITH_RECAST
+#include "Detour/DetourAlloc.h"
+#include "Detour/DetourNavMesh.h"
+#include "Detour/DetourNavMeshBuilder.h"
+#include "NavMesh/PImplRecastNavMesh.h"
+#include "NavMesh/RecastHelpers.h"
+#endif
+
+namespace {
+	// Detour stores tile vertices on a grid of this many units, so gathered polys are within half a unit of the synthetic ones.
+	constexpr float SyntheticCellSize = 1.f;
+	/*
+	* A slightly uneven height so detail triangles and floors aren't perfectly flat.
+	*/
+	double GetSyntheticHeight(double x, double y, int32 floor, double floorHeight) {
+		return floor * floorHeight + FMath::Sin(x * 0.01) * 5.0 + FMath::Cos(y * 0.01) * 5.0;
+	}
+}
+
+int32 NavMeshRender::GetSyntheticPolyGrid(const FNavMeshRenderSyntheticSettings& settings) {
+	return FMath::Max(1, FMath::CeilToInt(FMath::Sqrt((float)settings.PolysPerTile)));
+}
+
+void NavMeshRender::MakeSyntheticTiles(const FNavMeshRenderSyntheticSettings& settings, TArray<FNavMeshRenderTileSnapshot>& outTiles) {
+	const int32 polyGrid = GetSyntheticPolyGrid(settings);
+	const double polySize = settings.TileSize / polyGrid;
+	outTiles.Reset(settings.TilesPerSide * settings.TilesPerSide * settings.Floors);
+	for (int32 floor = 0; floor < settings.Floors; floor++) {
+		for (int32 tileY = 0; tileY < settings.TilesPerSide; tileY++) {
+			for (int32 tileX = 0; tileX < settings.TilesPerSide; tileX++) {
+				FNavMeshRenderTileSnapshot& tile = outTiles.AddDefaulted_GetRef();
+				tile.TileIndex = outTiles.Num() - 1;
+				tile.Signature = tile.TileIndex + 1;
+				tile.DataHash = GetTypeHash(tile.TileIndex);
+				tile.TileX = tileX;
+				tile.TileY = tileY;
+				const FVector2D tileCorner(tileX * settings.TileSize, tileY * settings.TileSize);
+				tile.Polys.Reserve(polyGrid * polyGrid);
+				for (int32 py = 0; py < polyGrid; py++) {
+					for (int32 px = 0; px < polyGrid; px++) {
+						FNavMeshRenderPolySnapshot& poly = tile.Polys.AddDefaulted_GetRef();
+						poly.PolyIndex = py * polyGrid + px;
+						poly.Ref = ((NavNodeRef)tile.TileIndex << 32) | (NavNodeRef)poly.PolyIndex;
+						const double x0 = tileCorner.X + px * polySize;
+						const double y0 = tileCorner.Y + py * polySize;
+						const double corners[4][2] = { { x0, y0 }, { x0 + polySize, y0 }, { x0 + polySize, y0 + polySize }, { x0, y0 + polySize } };
+						for (const auto& corner : corners) {
+							poly.Verts.Add(FVector(corner[0], corner[1], GetSyntheticHeight(corner[0], corner[1], floor, settings.FloorHeight)));
+							poly.Center += poly.Verts.Last();
+							tile.Bounds += poly.Verts.Last();
+						}
+						poly.Center /= poly.Verts.Num();
+						if (settings.Triangulation == ENavMeshRenderTriangulation::DetailMesh) {
+							poly.DetailTriangles = { poly.Verts[0], poly.Verts[1], poly.Verts[2], poly.Verts[0], poly.Verts[2], poly.Verts[3] };
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+FNavMeshRenderLayout NavMeshRender::MakeSyntheticLayout(const FNavMeshRenderSyntheticSettings& settings, const TArray<FNavMeshRenderTileSnapshot>& tiles) {
+	FBox bounds(ForceInit);
+	for (const FNavMeshRenderTileSnapshot& tile : tiles) {
+		bounds += tile.Bounds;
+	}
+	FNavMeshRenderLayout retVal;
+	retVal.NavMeshSize = bounds.GetSize();
+	retVal.NavMeshCorner = bounds.Min;
+	retVal.Triangulation = settings.Triangulation;
+	retVal.NumberOfFloors = settings.Floors;
+	for (int32 floor = 1; floor < settings.Floors; floor++) {
+		retVal.AdditionalFloorHeights.Add((floor - 0.5) * settings.FloorHeight);
+	}
+	retVal.FloorRowSize = settings.Floors > 1 ? FMath::Sqrt((float)settings.Floors) + 1 : 1;
+	return retVal;
+}
+
+bool NavMeshRender::MakeSyntheticNavMesh(const FNavMeshRenderSyntheticSettings& settings, const TArray<FNavMeshRenderTileSnapshot>& tiles, ARecastNavMesh& navMesh) {
+#if WITH_RECAST
+	FPImplRecastNavMesh* navMeshImpl = navMesh.GetRecastNavMeshImpl();
+	if (!navMeshImpl || tiles.IsEmpty()) {
+		return false;
+	}
+	const int32 polyGrid = GetSyntheticPolyGrid(settings);
+	dtNavMeshParams meshParams;
+	FMemory::Memzero(meshParams);
+	meshParams.tileWidth = settings.TileSize;
+	meshParams.tileHeight = settings.TileSize;
+	meshParams.maxTiles = tiles.Num();
+	meshParams.maxPolys = polyGrid * polyGrid;
+	dtNavMesh* detourMesh = dtAllocNavMesh();
+	if (!detourMesh || dtStatusFailed(detourMesh->init(&meshParams))) {
+		dtFreeNavMesh(detourMesh);
+		return false;
+	}
+	// The nav mesh owns the Detour mesh from here on, and frees it along with any tiles added below.
+	navMeshImpl->SetRecastMesh(detourMesh);
+	TMap<FIntVector, int32> vertIndices;
+	TArray<uint16> verts;
+	TArray<uint16> polys;
+	TArray<uint16> polyFlags;
+	TArray<uint8> polyAreas;
+	for (const FNavMeshRenderTileSnapshot& tile : tiles) {
+		const FBox recastBounds = Unreal2RecastBox(tile.Bounds.ExpandBy(SyntheticCellSize));
+		vertIndices.Reset();
+		verts.Reset();
+		polys.Reset();
+		polyFlags.Reset();
+		polyAreas.Reset();
+		auto addVert = [&](const FVector& location) {
+			const FVector relativeLocation = (Unreal2RecastPoint(location) - recastBounds.Min) / SyntheticCellSize;
+			const FIntVector cell(FMath::RoundToInt(relativeLocation.X), FMath::RoundToInt(relativeLocation.Y), FMath::RoundToInt(relativeLocation.Z));
+			if (const int32* existing = vertIndices.Find(cell)) {
+				return (uint16)*existing;
+			}
+			const int32 retVal = verts.Num() / 3;
+			verts.Append({ (uint16)cell.X, (uint16)cell.Y, (uint16)cell.Z });
+			vertIndices.Add(cell, retVal);
+			return (uint16)retVal;
+		};
+		for (const FNavMeshRenderPolySnapshot& poly : tile.Polys) {
+			// Corners followed by neighbors. Every edge is left a wall, gathering doesn't follow links.
+			const int32 firstCorner = polys.AddZeroed(DT_VERTS_PER_POLYGON * 2);
+			for (int32 k = 0; k < DT_VERTS_PER_POLYGON; k++) {
+				polys[firstCorner + k] = poly.Verts.IsValidIndex(k) ? addVert(poly.Verts[k]) : MAX_uint16;
+			}
+			polyFlags.Add(1);
+			polyAreas.Add(RECAST_DEFAULT_AREA);
+		}
+		dtNavMeshCreateParams createParams;
+		FMemory::Memzero(createParams);
+		createParams.verts = verts.GetData();
+		createParams.vertCount = verts.Num() / 3;
+		createParams.polys = polys.GetData();
+		createParams.polyFlags = polyFlags.GetData();
+		createParams.polyAreas = polyAreas.GetData();
+		createParams.polyCount = polyAreas.Num();
+		createParams.nvp = DT_VERTS_PER_POLYGON;
+		createParams.walkableHeight = SyntheticCellSize;
+		createParams.walkableClimb = SyntheticCellSize;
+		createParams.bmin[0] = recastBounds.Min.X;
+		createParams.bmin[1] = recastBounds.Min.Y;
+		createParams.bmin[2] = recastBounds.Min.Z;
+		createParams.bmax[0] = recastBounds.Max.X;
+		createParams.bmax[1] = recastBounds.Max.Y;
+		createParams.bmax[2] = recastBounds.Max.Z;
+		createParams.cs = SyntheticCellSize;
+		createParams.ch = SyntheticCellSize;
+		createParams.tileX = tile.TileX;
+		createParams.tileY = tile.TileY;
+		createParams.tileLayer = tile.TileIndex / (settings.TilesPerSide * settings.TilesPerSide);
+		createParams.buildBvTree = true;
+		// Without detail meshes Detour fans each poly into its own detail triangles.
+		unsigned char* tileData = nullptr;
+		int tileDataSize = 0;
+		if (!dtCreateNavMeshData(&createParams, &tileData, &tileDataSize)) {
+			return false;
+		}
+		if (dtStatusFailed(detourMesh->addTile(tileData, tileDataSize, DT_TILE_FREE_DATA, 0, nullptr))) {
+			dtFree(tileData, DT_ALLOC_PERM_TILE_DATA);
+			return false;
+		}
+	}
+	return true;
+#else
+	return false;
+#endif
+}
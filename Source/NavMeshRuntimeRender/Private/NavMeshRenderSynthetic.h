@@ -0,0 +1,45 @@
+// Cutter H // 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NavMeshRenderLayout.h"
+
+struct FNavMeshRenderTileSnapshot;
+class ARecastNavMesh;
+
+/*
+ * Shape of a generated nav mesh: a square grid of square tiles, each a square grid of square polys, repeated on every floor.
+ * Used by the benchmark commandlet and the automation tests, neither of which has a Recast nav mesh to gather from.
+ */
+struct FNavMeshRenderSyntheticSettings
+{
+	int32 TilesPerSide = 8;
+	int32 PolysPerTile = 64;
+	int32 Floors = 1;
+	double TileSize = 1000.0;
+	double FloorHeight = 400.0;
+	ENavMeshRenderTriangulation Triangulation = ENavMeshRenderTriangulation::CenterFan;
+};
+
+namespace NavMeshRender
+{
+	/*
+	* Polys along each side of a synthetic tile. PolysPerTile is rounded up to a square.
+	*/
+	int32 GetSyntheticPolyGrid(const FNavMeshRenderSyntheticSettings& settings);
+	/*
+	* Lays out the same square grid of square polys on every floor, the way GatherTiles would copy them out of Recast.
+	* Each poly is split into two detail triangles for ENavMeshRenderTriangulation::DetailMesh.
+	*/
+	void MakeSyntheticTiles(const FNavMeshRenderSyntheticSettings& settings, TArray<FNavMeshRenderTileSnapshot>& outTiles);
+	/*
+	* Matches the layout ANavMeshRenderer::MakeRenderLayout would make for the synthetic bounds, with a floor height between every two floors.
+	*/
+	FNavMeshRenderLayout MakeSyntheticLayout(const FNavMeshRenderSyntheticSettings& settings, const TArray<FNavMeshRenderTileSnapshot>& tiles);
+	/*
+	* Builds the tiles into Detour tile data and hands it to the nav mesh, so GatherTiles reads them the way it reads a generated nav mesh.
+	* Each floor is its own tile layer. Returns false without Recast or if Detour rejects a tile.
+	*/
+	bool MakeSyntheticNavMesh(const FNavMeshRenderSyntheticSettings& settings, const TArray<FNavMeshRenderTileSnapshot>& tiles, ARecastNavMesh& navMesh);
+}
@@ -0,0 +1,287 @@
+// Cutter H // 2024
+
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "NavMeshRenderBuilder.h"
+#include "NavMeshRenderHit.h"
+#include "NavMeshRenderSpatialIndex.h"
+#include "NavMeshRenderSynthetic.h"
+#include "Misc/EngineVersionComparison.h"
+
+#if UE_VERSION_OLDER_THAN(5, 5, 0)
+#define NAVMESHRENDER_TEST_FLAGS (EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+#else
+#define NAVMESHRENDER_TEST_FLAGS (EAutomationTestFlags_ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+#endif
+
+namespace {
+	constexpr float UVTolerance = 1e-4f;
+
+	/*
+	* A triangle by its corner positions, rotated so the smallest corner comes first. Winding is kept.
+	*/
+	struct FTriangleKey
+	{
+		FIntVector Corners[3];
+
+		bool operator==(const FTriangleKey& other) const {
+			return Corners[0] == other.Corners[0] && Corners[1] == other.Corners[1] && Corners[2] == other.Corners[2];
+		}
+	};
+
+	bool IsCornerLess(const FIntVector& a, const FIntVector& b) {
+		if (a.X != b.X) {
+			return a.X < b.X;
+		}
+		if (a.Y != b.Y) {
+			return a.Y < b.Y;
+		}
+		return a.Z < b.Z;
+	}
+
+	/*
+	* Every triangle of the mesh in a fixed order, so meshes built in different orders can be compared.
+	*/
+	TArray<FTriangleKey> GetTriangleKeys(const UE::Geometry::FDynamicMesh3& mesh) {
+		TArray<FTriangleKey> retVal;
+		retVal.Reserve(mesh.TriangleCount());
+		for (int32 tid : mesh.TriangleIndicesItr()) {
+			const UE::Geometry::FIndex3i tri = mesh.GetTriangle(tid);
+			FIntVector corners[3];
+			int32 first = 0;
+			for (int32 k = 0; k < 3; k++) {
+				const FVector position = mesh.GetVertex(tri[k]);
+				corners[k] = FIntVector(FMath::RoundToInt(position.X * 10.0), FMath::RoundToInt(position.Y * 10.0), FMath::RoundToInt(position.Z * 10.0));
+				if (k > 0 && IsCornerLess(corners[k], corners[first])) {
+					first = k;
+				}
+			}
+			FTriangleKey& key = retVal.AddDefaulted_GetRef();
+			for (int32 k = 0; k < 3; k++) {
+				key.Corners[k] = corners[(first + k) % 3];
+			}
+		}
+		retVal.Sort([](const FTriangleKey& a, const FTriangleKey& b) {
+			for (int32 k = 0; k < 3; k++) {
+				if (a.Corners[k] != b.Corners[k]) {
+					return IsCornerLess(a.Corners[k], b.Corners[k]);
+				}
+			}
+			return false;
+		});
+		return retVal;
+	}
+
+	/*
+	* Random locations across the layout's bounds, at heights spread over every floor.
+	*/
+	TArray<FVector> MakeRandomLocations(const FNavMeshRenderLayout& layout, int32 count) {
+		FRandomStream random(1234);
+		TArray<FVector> retVal;
+		retVal.SetNumUninitialized(count);
+		for (FVector& location : retVal) {
+			location = layout.NavMeshCorner + FVector(random.FRand(), random.FRand(), random.FRand()) * layout.NavMeshSize;
+		}
+		return retVal;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNavMeshRenderTriangulationTest, "NavMeshRuntimeRender.Triangulation", NAVMESHRENDER_TEST_FLAGS)
+
+bool FNavMeshRenderTriangulationTest::RunTest(const FString& Parameters) {
+	FNavMeshRenderSyntheticSettings settings;
+	settings.TilesPerSide = 3;
+	settings.PolysPerTile = 16;
+	const int32 polysPerSide = settings.TilesPerSide * NavMeshRender::GetSyntheticPolyGrid(settings);
+	const int32 polyCount = polysPerSide * polysPerSide;
+	// The square polys share their corners across tiles, the center fan adds one center per poly.
+	const int32 cornerCount = (polysPerSide + 1) * (polysPerSide + 1);
+	const ENavMeshRenderTriangulation triangulations[] = { ENavMeshRenderTriangulation::CenterFan, ENavMeshRenderTriangulation::ConvexFan, ENavMeshRenderTriangulation::DetailMesh };
+	for (ENavMeshRenderTriangulation triangulation : triangulations) {
+		settings.Triangulation = triangulation;
+		TArray<FNavMeshRenderTileSnapshot> tiles;
+		NavMeshRender::MakeSyntheticTiles(settings, tiles);
+		const FNavMeshRenderLayout layout = NavMeshRender::MakeSyntheticLayout(settings, tiles);
+		UE::Geometry::FDynamicMesh3 mesh;
+		FNavMeshRenderMeshState state;
+		NavMeshRender::BuildMesh(layout, tiles, mesh, state);
+		const FString name = StaticEnum<ENavMeshRenderTriangulation>()->GetNameStringByValue((int64)triangulation);
+		const bool bCenterFan = triangulation == ENavMeshRenderTriangulation::CenterFan;
+		TestEqual(FString::Printf(TEXT("%s triangles"), *name), mesh.TriangleCount(), polyCount * (bCenterFan ? 4 : 2));
+		TestEqual(FString::Printf(TEXT("%s vertices"), *name), mesh.VertexCount(), cornerCount + (bCenterFan ? polyCount : 0));
+		TestEqual(FString::Printf(TEXT("%s tiles"), *name), state.TileTriangles.Num(), tiles.Num());
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNavMeshRenderUVCoordsTest, "NavMeshRuntimeRender.UVCoords", NAVMESHRENDER_TEST_FLAGS)
+
+bool FNavMeshRenderUVCoordsTest::RunTest(const FString& Parameters) {
+	FNavMeshRenderSyntheticSettings settings;
+	settings.TilesPerSide = 2;
+	settings.PolysPerTile = 4;
+	settings.Floors = 3;
+	TArray<FNavMeshRenderTileSnapshot> tiles;
+	NavMeshRender::MakeSyntheticTiles(settings, tiles);
+	FNavMeshRenderLayout layout = NavMeshRender::MakeSyntheticLayout(settings, tiles);
+	layout.UV_IslandMargins = 0.02f;
+	const TArray<FVector> locations = MakeRandomLocations(layout, 512);
+	TArray<float> centralHeights;
+	for (const FVector& location : locations) {
+		centralHeights.Add(location.Z + 50.f);
+	}
+	// Once with the grid of floors and once with packed floors, each with and without central heights.
+	for (int32 pass = 0; pass < 2; pass++) {
+		if (pass == 1) {
+			TArray<FBox2D> floorBounds;
+			floorBounds.Init(FBox2D(FVector2D::ZeroVector, FVector2D(layout.NavMeshSize)), settings.Floors);
+			floorBounds[1] = FBox2D(FVector2D::ZeroVector, FVector2D(layout.NavMeshSize) * 0.5);
+			FNavMeshRenderLayout::PackFloors(floorBounds, layout.UV_IslandMargins, layout.FloorUVTransforms);
+		}
+		TArray<FVector2f> uvs;
+		uvs.SetNumUninitialized(locations.Num());
+		layout.UVCoords(locations, TConstArrayView<float>(), uvs);
+		TArray<FVector2f> centralUVs;
+		centralUVs.SetNumUninitialized(locations.Num());
+		layout.UVCoords(locations, centralHeights, centralUVs);
+		for (int32 i = 0; i < locations.Num(); i++) {
+			const FVector2f uv = layout.UVCoord(locations[i], locations[i].Z);
+			const FVector2f centralUV = layout.UVCoord(locations[i], centralHeights[i]);
+			if (!uvs[i].Equals(uv, UVTolerance) || !centralUVs[i].Equals(centralUV, UVTolerance)) {
+				AddError(FString::Printf(TEXT("UVCoords differs from UVCoord at %s with %s floors"), *locations[i].ToString(), pass == 0 ? TEXT("grid") : TEXT("packed")));
+				break;
+			}
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNavMeshRenderTilePatchTest, "NavMeshRuntimeRender.TilePatch", NAVMESHRENDER_TEST_FLAGS)
+
+bool FNavMeshRenderTilePatchTest::RunTest(const FString& Parameters) {
+	FNavMeshRenderSyntheticSettings settings;
+	settings.TilesPerSide = 4;
+	settings.PolysPerTile = 16;
+	settings.Floors = 2;
+	TArray<FNavMeshRenderTileSnapshot> tiles;
+	NavMeshRender::MakeSyntheticTiles(settings, tiles);
+	const FNavMeshRenderLayout layout = NavMeshRender::MakeSyntheticLayout(settings, tiles);
+	UE::Geometry::FDynamicMesh3 patchedMesh;
+	FNavMeshRenderMeshState patchedState;
+	NavMeshRender::BuildMesh(layout, tiles, patchedMesh, patchedState);
+
+	// An inner tile, a border tile and a tile on the second floor lose every other poly, the way Recast regenerates a tile around a new obstacle.
+	const TArray<int32> dirtyTiles = { 5, 12, 16 + 6 };
+	TArray<FNavMeshRenderTileSnapshot> changedTiles;
+	for (int32 tileIndex : dirtyTiles) {
+		FNavMeshRenderTileSnapshot& tile = tiles[tileIndex];
+		for (int32 p = tile.Polys.Num() - 1; p >= 0; p -= 2) {
+			tile.Polys.RemoveAt(p);
+		}
+		tile.Signature += 1000;
+		changedTiles.Add(tile);
+	}
+	TArray<FNavMeshRenderTileBuffers> tileBuffers;
+	TArray<FNavMeshRenderTileIndex> tileIndices;
+	NavMeshRender::RebuildTiles(layout, dirtyTiles, changedTiles, tileBuffers, patchedMesh, patchedState, tileIndices);
+
+	UE::Geometry::FDynamicMesh3 fullMesh;
+	FNavMeshRenderMeshState fullState;
+	NavMeshRender::BuildMesh(layout, tiles, fullMesh, fullState);
+	TestEqual(TEXT("Triangles"), patchedMesh.TriangleCount(), fullMesh.TriangleCount());
+	TestEqual(TEXT("Vertices"), patchedMesh.VertexCount(), fullMesh.VertexCount());
+	TestTrue(TEXT("Triangle positions"), GetTriangleKeys(patchedMesh) == GetTriangleKeys(fullMesh));
+	TestEqual(TEXT("Nav data hash"), NavMeshRender::GetNavDataHash(patchedState), NavMeshRender::GetNavDataHash(fullState));
+	TestEqual(TEXT("Tile indices"), tileIndices.Num(), dirtyTiles.Num());
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNavMeshRenderSpatialIndexTest, "NavMeshRuntimeRender.SpatialIndex", NAVMESHRENDER_TEST_FLAGS)
+
+bool FNavMeshRenderSpatialIndexTest::RunTest(const FString& Parameters) {
+	FNavMeshRenderSyntheticSettings settings;
+	settings.TilesPerSide = 3;
+	settings.PolysPerTile = 16;
+	settings.Floors = 2;
+	const ENavMeshRenderTriangulation triangulations[] = { ENavMeshRenderTriangulation::CenterFan, ENavMeshRenderTriangulation::ConvexFan };
+	for (ENavMeshRenderTriangulation triangulation : triangulations) {
+		settings.Triangulation = triangulation;
+		TArray<FNavMeshRenderTileSnapshot> tiles;
+		NavMeshRender::MakeSyntheticTiles(settings, tiles);
+		const FNavMeshRenderLayout layout = NavMeshRender::MakeSyntheticLayout(settings, tiles);
+		TArray<FNavMeshRenderTileIndex> tileIndices;
+		NavMeshRender::BuildTileIndices(layout, tiles, tileIndices);
+		FNavMeshRenderSpatialIndex spatialIndex;
+		for (FNavMeshRenderTileIndex& tileIndex : tileIndices) {
+			spatialIndex.AddTile(MoveTemp(tileIndex));
+		}
+		spatialIndex.MarkComplete();
+
+		int32 misses = 0;
+		for (const FNavMeshRenderTileSnapshot& tile : tiles) {
+			for (const FNavMeshRenderPolySnapshot& poly : tile.Polys) {
+				// Off the center, so the point is inside a single triangle of either fan.
+				const FVector location = FMath::Lerp(poly.Center, poly.Verts[1], 0.25);
+				FNavMeshRenderHit hit;
+				if (!spatialIndex.FindHit(location, settings.FloorHeight * 0.25f, hit) || hit.PolyRef != (int64)poly.Ref || hit.TileIndex != tile.TileIndex) {
+					misses++;
+					continue;
+				}
+				TestEqual(TEXT("Hit floor"), hit.Floor, layout.GetFloor(poly.Center.Z));
+				TestTrue(TEXT("Hit UV"), FVector2f(hit.UV).Equals(layout.UVCoord(hit.Location, poly.Center.Z), UVTolerance));
+			}
+		}
+		TestEqual(TEXT("Polys not hit"), misses, 0);
+		FNavMeshRenderHit hit;
+		TestFalse(TEXT("Hit outside the nav mesh"), spatialIndex.FindHit(layout.NavMeshCorner - FVector(500.0, 500.0, 0.0), 1000.f, hit));
+		TestFalse(TEXT("Hit between floors"), spatialIndex.FindHit(tiles[0].Polys[0].Center + FVector(0.0, 0.0, settings.FloorHeight * 0.5), 10.f, hit));
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FNavMeshRenderPackFloorsTest, "NavMeshRuntimeRender.PackFloors", NAVMESHRENDER_TEST_FLAGS)
+
+bool FNavMeshRenderPackFloorsTest::RunTest(const FString& Parameters) {
+	const float margin = 0.02f;
+	TArray<FBox2D> floorBounds;
+	floorBounds.Add(FBox2D(FVector2D(0.0, 0.0), FVector2D(1000.0, 500.0)));
+	floorBounds.Add(FBox2D(FVector2D(100.0, 100.0), FVector2D(400.0, 900.0)));
+	floorBounds.Add(FBox2D(ForceInit));
+	floorBounds.Add(FBox2D(FVector2D(600.0, 0.0), FVector2D(800.0, 200.0)));
+	TArray<FVector4> transforms;
+	FNavMeshRenderLayout::PackFloors(floorBounds, margin, transforms);
+	if (!TestEqual(TEXT("Transforms"), transforms.Num(), floorBounds.Num())) {
+		return false;
+	}
+	TestTrue(TEXT("Empty floor"), transforms[2] == FVector4(0.0, 0.0, 0.0, 0.0));
+
+	TArray<FBox2D> packed;
+	for (int32 floor = 0; floor < floorBounds.Num(); floor++) {
+		if (!floorBounds[floor].bIsValid) {
+			continue;
+		}
+		const FVector4& transform = transforms[floor];
+		TestTrue(TEXT("Uniform scale"), transform.X > 0.0 && FMath::IsNearlyEqual(transform.X, transform.Y) && FMath::IsNearlyEqual(transform.X, transforms[0].X));
+		const FBox2D uvBounds(
+			floorBounds[floor].Min * FVector2D(transform.X, transform.Y) + FVector2D(transform.Z, transform.W),
+			floorBounds[floor].Max * FVector2D(transform.X, transform.Y) + FVector2D(transform.Z, transform.W));
+		TestTrue(TEXT("Inside the UV square"), uvBounds.Min.X >= -UVTolerance && uvBounds.Min.Y >= -UVTolerance && uvBounds.Max.X <= 1.0 + UVTolerance && uvBounds.Max.Y <= 1.0 + UVTolerance);
+		for (const FBox2D& other : packed) {
+			// Separated by at least the margin along one axis.
+			const bool bSeparated = uvBounds.Min.X >= other.Max.X + margin - UVTolerance || other.Min.X >= uvBounds.Max.X + margin - UVTolerance
+				|| uvBounds.Min.Y >= other.Max.Y + margin - UVTolerance || other.Min.Y >= uvBounds.Max.Y + margin - UVTolerance;
+			TestTrue(TEXT("Floors apart"), bSeparated);
+		}
+		packed.Add(uvBounds);
+	}
+
+	// A single floor fills the square along its longer side.
+	FNavMeshRenderLayout::PackFloors(MakeArrayView(floorBounds.GetData(), 1), margin, transforms);
+	TestTrue(TEXT("Single floor scale"), FMath::IsNearlyEqual(transforms[0].X, 1.0 / 1000.0));
+	return true;
+}
+
+#endif
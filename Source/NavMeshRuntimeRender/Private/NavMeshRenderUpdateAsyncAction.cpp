@@ -0,0 +1,33 @@
+// Cutter H // 2024
+
+
+#include "NavMeshRenderUpdateAsyncAction.h"
+
+UNavMeshRenderUpdateAsyncAction* UNavMeshRenderUpdateAsyncAction::UpdateNavMeshRenderAsync(ANavMeshRenderer* renderer) {
+	UNavMeshRenderUpdateAsyncAction* retVal = NewObject<UNavMeshRenderUpdateAsyncAction>();
+	retVal->Renderer = renderer;
+	retVal->RegisterWithGameInstance(renderer);
+	return retVal;
+}
+
+void UNavMeshRenderUpdateAsyncAction::Activate() {
+	if (!IsValid(Renderer)) {
+		Failed.Broadcast();
+		SetReadyToDestroy();
+		return;
+	}
+	Renderer->OnMeshUpdate.AddDynamic(this, &UNavMeshRenderUpdateAsyncAction::HandleMeshUpdate);
+	if (!Renderer->UpdateMeshAsync()) {
+		Renderer->OnMeshUpdate.RemoveDynamic(this, &UNavMeshRenderUpdateAsyncAction::HandleMeshUpdate);
+		Failed.Broadcast();
+		SetReadyToDestroy();
+	}
+}
+
+void UNavMeshRenderUpdateAsyncAction::HandleMeshUpdate() {
+	if (IsValid(Renderer)) {
+		Renderer->OnMeshUpdate.RemoveDynamic(this, &UNavMeshRenderUpdateAsyncAction::HandleMeshUpdate);
+	}
+	Completed.Broadcast();
+	SetReadyToDestroy();
+}
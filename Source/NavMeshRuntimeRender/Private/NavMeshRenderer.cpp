@@ -3,15 +3,31 @@
 
 #include "NavMeshRenderer.h"
 #include "DynamicNavMeshRendererComponent.h"
+#include "NavMeshCompactRenderComponent.h"
+#include "NavMeshRenderBuilder.h"
+#include "NavMeshRenderStats.h"
+#include "NavMeshRenderStreaming.h"
+#include "NavMeshRenderRaster.h"
+#include "NavMeshRenderHighlights.h"
 
 #include "NavigationSystem.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+#include "TimerManager.h"
 #include "NavMesh/RecastNavMesh.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "Engine/Texture2D.h"
+#include "Misc/App.h"
 
 #include "CustomMeshComponent.h"
+#include "Components/LineBatchComponent.h"
 #include "Components/DynamicMeshComponent.h"
 
-#include "DynamicMesh/MeshAttributeUtil.h"
+#include "DynamicMeshEditor.h"
+#include "Async/ParallelFor.h"
 #include "Runtime/CoreUObject/Public/UObject/ConstructorHelpers.h"
+#include "Async/Async.h"
+#include "Tasks/Task.h"
 
 #include "ModelingObjectsCreationAPI.h"
 #include "AssetUtils/CreateStaticMeshUtil.h"
@@ -43,6 +59,9 @@ ANavMeshRenderer::ANavMeshRenderer() {
 			}
 		}
 	}
+	// Ticking is only turned on while a time sliced update is running.
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
 	SetActorTickEnabled(false);
 #if WITH_EDITOR
 	if (IsSelectedInEditor() && bShowFloorDebug) {
@@ -57,12 +76,17 @@ ANavMeshRenderer::ANavMeshRenderer() {
 }
 
 void ANavMeshRenderer::PostLoadSubobjects(FObjectInstancingGraph* OuterInstanceGraph) {
-	UpdateMesh();
+	RefreshRenderLayout();
+	UpdateMeshIfStale();
 	Super::PostLoadSubobjects(OuterInstanceGraph);
 }
 
 void ANavMeshRenderer::OnConstruction(const FTransform& transform) {
 		SetActorTransform(FTransform());
+	RefreshRenderLayout();
+	// Area masks, agent materials and visibility apply without a rebuild.
+	ApplyMaterialParameters();
+	RefreshOutline();
 #if WITH_EDITOR
 	if(bShowFloorDebug) {
 		DrawFloors();
@@ -81,127 +105,451 @@ void ANavMeshRenderer::OnConstruction(const FTransform& transform) {
 
 void ANavMeshRenderer::BeginPlay() {
 	Super::BeginPlay();
+	ApplyMaterialParameters();
 	if (IsValid(FloorDebug)) {
 		FloorDebug->DestroyComponent();
 	}
+	if (ShouldStream()) {
+		if (!IsStreaming()) {
+			RestartStreaming();
+		}
+	}
+	else if (!bRenderCacheChecked) {
+		UpdateMeshIfStale();
+	}
+	if (bUpdateChangedTiles) {
+		if (UNavigationSystemV1* navSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld())) {
+			navSys->OnNavigationGenerationFinishedDelegate.AddUniqueDynamic(this, &ANavMeshRenderer::OnNavigationGenerationFinished);
+		}
+	}
+	if (bFollowNavStreaming && !LevelAddedHandle.IsValid()) {
+		LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &ANavMeshRenderer::OnLevelStreamingChanged);
+		LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &ANavMeshRenderer::OnLevelStreamingChanged);
+	}
+}
+
+void ANavMeshRenderer::EndPlay(const EEndPlayReason::Type endPlayReason) {
+	if (UNavigationSystemV1* navSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld())) {
+		navSys->OnNavigationGenerationFinishedDelegate.RemoveDynamic(this, &ANavMeshRenderer::OnNavigationGenerationFinished);
+	}
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+	LevelAddedHandle.Reset();
+	LevelRemovedHandle.Reset();
+	Streaming.Reset();
+	UpdateTickEnabled();
+	Super::EndPlay(endPlayReason);
+}
+
+void ANavMeshRenderer::BeginDestroy() {
+	SetMemoryStats(0, 0, 0, 0, 0);
+	Super::BeginDestroy();
+}
+
+void ANavMeshRenderer::Tick(float deltaSeconds) {
+	Super::Tick(deltaSeconds);
+	if (TimeSlicedBuild.IsValid()) {
+		ContinueTimeSlicedBuild();
+	}
+	if (Streaming.IsValid()) {
+		StreamingTimeSinceUpdate += deltaSeconds;
+		if (StreamingTimeSinceUpdate >= StreamingUpdateInterval) {
+			UpdateStreaming();
+		}
+	}
+}
+
+bool ANavMeshRenderer::ShouldTickIfViewportsOnly() const {
+	return TimeSlicedBuild.IsValid();
 }
 
 const UDynamicMeshComponent* ANavMeshRenderer::GetNavMeshRender() const {
     return DynamicNavMeshRender;
 }
 
+TArray<UDynamicMeshComponent*> ANavMeshRenderer::GetNavMeshRenderChunks() const {
+	TArray<UDynamicMeshComponent*> retVal;
+	for (const TPair<FIntPoint, TObjectPtr<UDynamicNavMeshRendererComponent>>& chunk : ChunkComponents) {
+		if (IsValid(chunk.Value)) {
+			retVal.Add(chunk.Value);
+		}
+	}
+	return retVal;
+}
+
 FVector2D ANavMeshRenderer::GetUV_Coordinate(const FVector& location, float centralHeight) const {
 	FVector2f retVal = UVCoord(location, centralHeight);
 	return FVector2D(retVal.X, retVal.Y);
 }
 
+void ANavMeshRenderer::GetUV_Coordinates(const TArray<FVector>& locations, const TArray<float>& centralHeights, TArray<FVector2D>& outUVs) const {
+	NAVMESHRENDER_SCOPE_CYCLE_COUNTER(STAT_NavMeshRender_UVCoords);
+	outUVs.Reset();
+	if (centralHeights.Num() != locations.Num() && centralHeights.Num() > 0) {
+		UE_LOG(LogNavigation, Error, TEXT("GetUV_Coordinates got %d central heights for %d locations."), centralHeights.Num(), locations.Num());
+		return;
+	}
+	TArray<FVector2f> uvs;
+	uvs.SetNumUninitialized(locations.Num());
+	RenderLayout.UVCoords(locations, centralHeights, uvs);
+	outUVs.SetNumUninitialized(uvs.Num());
+	for (int32 i = 0; i < uvs.Num(); i++) {
+		outUVs[i] = FVector2D(uvs[i].X, uvs[i].Y);
+	}
+}
+
+void ANavMeshRenderer::GetFloorUVTransform(int32 floor, FVector2D& outScale, FVector2D& outOffset) const {
+	const FVector4 floorTransform = RenderLayout.GetFloorUVTransform(floor);
+	outScale = FVector2D(floorTransform.X, floorTransform.Y);
+	// The layout's transform is relative to the nav mesh corner.
+	outOffset = FVector2D(floorTransform.Z, floorTransform.W) - FVector2D(RenderLayout.NavMeshCorner) * outScale;
+}
+
+FNavMeshRenderLayout ANavMeshRenderer::GetRenderLayout() const {
+	return RenderLayout;
+}
+
+bool ANavMeshRenderer::FindRenderHit(const FVector& location, FNavMeshRenderHit& outHit, float maxHeightDelta) {
+	const FNavMeshRenderSpatialIndex* spatialIndex = EnsureSpatialIndex();
+	if (!spatialIndex) {
+		outHit = FNavMeshRenderHit();
+		return false;
+	}
+	return spatialIndex->FindHit(location, maxHeightDelta, outHit);
+}
+
+void ANavMeshRenderer::SetAreaMask(int64 areaMask) {
+	AreaMask = areaMask;
+	ApplyMaterialParameters();
+}
+
+int64 ANavMeshRenderer::GetAreaMask() const {
+	return AreaMask;
+}
+
+void ANavMeshRenderer::SetAgentVisibility(FName agentName, bool bVisible) {
+	for (FNavMeshRenderAgent& agent : Agents) {
+		if (agent.AgentName == agentName) {
+			agent.bVisible = bVisible;
+		}
+	}
+	RefreshAgentComponents();
+}
+
+UDynamicMeshComponent* ANavMeshRenderer::GetAgentRender(FName agentName) const {
+	const TObjectPtr<UDynamicNavMeshRendererComponent>* agentComponent = AgentComponents.Find(agentName);
+	return agentComponent ? agentComponent->Get() : nullptr;
+}
+
+void ANavMeshRenderer::FindRenderHits(const TArray<FVector>& locations, TArray<FNavMeshRenderHit>& outHits, float maxHeightDelta) {
+	NAVMESHRENDER_SCOPE_CYCLE_COUNTER(STAT_NavMeshRender_FindRenderHits);
+	outHits.SetNum(locations.Num());
+	const FNavMeshRenderSpatialIndex* spatialIndex = EnsureSpatialIndex();
+	if (!spatialIndex) {
+		for (FNavMeshRenderHit& hit : outHits) {
+			hit = FNavMeshRenderHit();
+		}
+		return;
+	}
+	// Queries only read the index, so large batches are spread over workers.
+	ParallelFor(locations.Num(), [spatialIndex, &locations, &outHits, maxHeightDelta](int32 i) {
+		spatialIndex->FindHit(locations[i], maxHeightDelta, outHits[i]);
+	}, locations.Num() < 256 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+}
+
  void ANavMeshRenderer::UpdateMesh(){
-	 if (!IsValid(DynamicNavMeshRender)) {
-		 DynamicNavMeshRender = CreateDefaultSubobject<UDynamicNavMeshRendererComponent>(TEXT("NavMeshRender"));
-		 if (IsValid(DynamicNavMeshRender)) {
-			 DynamicNavMeshRender->SetupAttachment(GetRootComponent());
-			 if (NumberOfTris > 0) {
-				 if (IsValid(NavMeshMaterial)) {
-					 DynamicNavMeshRender->SetMaterial(0, NavMeshMaterial);
-				 }
-			 }
-		 }
+	 NAVMESHRENDER_SCOPE_CYCLE_COUNTER(STAT_NavMeshRender_UpdateMesh);
+	 if (ShouldStream()) {
+		 RestartStreaming();
+		 return;
+	 }
+	 TArray<FNavMeshRenderTileSnapshot> tiles;
+	 uint32 settingsHash = 0;
+	 FNavMeshRenderLayout layout;
+	 if (!SnapshotNavMesh(tiles, settingsHash, layout)) {
+		 return;
+	 }
+	 TArray<FNavMeshRenderAgentBuild> agentBuilds;
+	 SnapshotAgents(layout.Triangulation, agentBuilds);
+	 // Supersedes any asynchronous update that is still running.
+	 LatestBuildSerial++;
+	 TArray<FNavMeshRenderChunk> builtChunks;
+	 NavMeshRender::BuildChunks(layout, tiles, ChunkSizeInTiles, builtChunks);
+	 NavMeshRender::BuildAgentMeshes(layout, agentBuilds);
+	 ApplyBuiltChunks(layout, MoveTemp(builtChunks), MoveTemp(agentBuilds), ChunkSizeInTiles, settingsHash);
+}
+
+ bool ANavMeshRenderer::UpdateMeshTimeSliced() {
+	 CancelTimeSlicedBuild();
+	 if (ShouldStream()) {
+		 RestartStreaming();
+		 return IsStreaming();
+	 }
+	 const ARecastNavMesh* navMesh = PrepareBuild(TimeSlicedLayout);
+	 if (!IsValid(navMesh)) {
+		 return false;
+	 }
+	 // Supersedes any other update that is still running.
+	 TimeSlicedBuildSerial = ++LatestBuildSerial;
+	 TimeSlicedSettingsHash = GetSettingsHash(*navMesh);
+	 TimeSlicedChunkSizeInTiles = ChunkSizeInTiles;
+	 TimeSlicedBuild = MakeShared<FNavMeshRenderTimeSlicedBuild>(TimeSlicedLayout, ChunkSizeInTiles, navMesh->GetNavMeshTilesCount());
+	 for (const TPair<FName, const ARecastNavMesh*>& agentNavMesh : GetAgentNavMeshes()) {
+		 TimeSlicedBuild->AddAgent(agentNavMesh.Key, *agentNavMesh.Value);
+	 }
+	 SetActorTickEnabled(true);
+	 ContinueTimeSlicedBuild();
+	 return true;
+ }
+
+ float ANavMeshRenderer::GetBuildProgress() const {
+	 return TimeSlicedBuild.IsValid() ? TimeSlicedBuild->GetProgress() : 1.f;
+ }
+
+ void ANavMeshRenderer::ContinueTimeSlicedBuild() {
+	 NAVMESHRENDER_SCOPE_CYCLE_COUNTER(STAT_NavMeshRender_TimeSlicedUpdate);
+	 // Superseded by another update or a clear.
+	 if (TimeSlicedBuildSerial != LatestBuildSerial) {
+		 CancelTimeSlicedBuild();
+		 return;
 	 }
 	 const ARecastNavMesh* navMesh = GetNavMesh();
 	 if (!IsValid(navMesh)) {
-		 UE_LOG(LogNavigation, Warning, TEXT("NavMeshRenderer found no Navigation Mesh"));
+		 CancelTimeSlicedBuild();
 		 return;
 	 }
-	 NavMeshSize = navMesh->GetBounds().GetSize();
-	 NavMeshCorner = navMesh->GetBounds().GetCenter() - NavMeshSize / 2;
-	 NumberOfFloors = 1;
-	 AdditionalFloorHeights.Sort();
-	 for (float floorHeight : AdditionalFloorHeights) {
-		 if (floorHeight <= NavMeshSize.Z && floorHeight > 0) {
-			 NumberOfFloors++;
+	 const double sliceEndTime = FPlatformTime::Seconds() + TimeSliceBudgetMs / 1000.0;
+	 do {
+		 TimeSlicedBuild->BuildNextTile(*navMesh);
+	 } while (!TimeSlicedBuild->IsFinished() && FPlatformTime::Seconds() < sliceEndTime);
+	 OnMeshBuildProgress.Broadcast(TimeSlicedBuild->GetProgress());
+	 if (!TimeSlicedBuild->IsFinished()) {
+		 return;
+	 }
+	 // Additional agents were built by the same slices, after the main tiles.
+	 TArray<FNavMeshRenderChunk> builtChunks = TimeSlicedBuild->TakeChunks();
+	 TArray<FNavMeshRenderAgentBuild> agentBuilds = TimeSlicedBuild->TakeAgentBuilds();
+	 TimeSlicedBuild.Reset();
+	 UpdateTickEnabled();
+	 ApplyBuiltChunks(TimeSlicedLayout, MoveTemp(builtChunks), MoveTemp(agentBuilds), TimeSlicedChunkSizeInTiles, TimeSlicedSettingsHash);
+ }
+
+ void ANavMeshRenderer::CancelTimeSlicedBuild() {
+	 TimeSlicedBuild.Reset();
+	 UpdateTickEnabled();
+ }
+
+ bool ANavMeshRenderer::UpdateMeshIfStale() {
+	 // Streaming never keeps a full render to compare against.
+	 if (ShouldStream()) {
+		 if (!IsStreaming()) {
+			 RestartStreaming();
+		 }
+		 return false;
+	 }
+	 const ARecastNavMesh* navMesh = GetNavMesh();
+	 if (!IsValid(navMesh)) {
+		 return false;
+	 }
+	 bRenderCacheChecked = true;
+	 // Hashing the tile data is a single pass over memory, far cheaper than triangulating it again.
+	 if (BuiltNavDataHash != 0 && BuiltSettingsHash == GetSettingsHash(*navMesh) && BuiltNavDataHash == NavMeshRender::GetNavDataHash(*navMesh)
+		 && BuiltAgentsNavDataHash == GetAgentsNavDataHash()) {
+		 UE_LOG(LogNavigation, Log, TEXT("NavMeshRenderer reused the saved render."));
+		 UpdateRenderStats();
+		 RebuildOutline();
+		 if (bRasterizeAtlas) {
+			 UpdateRaster();
+		 }
+		 RefreshHighlights();
+		 return false;
+	 }
+	 UpdateMesh();
+	 return true;
+ }
+
+ bool ANavMeshRenderer::UpdateChangedTiles() {
+	 NAVMESHRENDER_SCOPE_CYCLE_COUNTER(STAT_NavMeshRender_UpdateChangedTiles);
+	 if (IsStreaming()) {
+		 RefreshStreamingTiles();
+		 if (bRasterizeAtlas) {
+			 UpdateRaster();
+		 }
+		 RefreshHighlights();
+		 return true;
+	 }
+	 // The running build will pick up the changed tiles when it snapshots again.
+	 if (bAsyncBuildInFlight) {
+		 return UpdateMeshAsync();
+	 }
+	 FNavMeshRenderLayout layout;
+	 const ARecastNavMesh* navMesh = PrepareBuild(layout);
+	 if (!IsValid(navMesh)) {
+		 return false;
+	 }
+	 // Where each built tile lives and the signature it was built from.
+	 TMap<int32, UDynamicNavMeshRendererComponent*> builtTiles;
+	 bool bHasRenderState = true;
+	 for (UDynamicNavMeshRendererComponent* renderComponent : GetRenderComponents()) {
+		 if (!renderComponent->RenderState.IsValid()) {
+			 bHasRenderState = false;
+			 break;
+		 }
+		 for (const TPair<int32, uint64>& builtTile : renderComponent->RenderState->TileSignatures) {
+			 builtTiles.Add(builtTile.Key, renderComponent);
 		 }
 	 }
-	 DynamicNavMeshRender->BoundsExtents = NavMeshSize;
-	 DynamicNavMeshRender->UpdateBounds();
-	 FloorRowSize = 1;
-	 if(NumberOfFloors > 1) {
-		  FloorRowSize = sqrt(NumberOfFloors)+1;
+	 // Moved bounds or floors change every UV and a new chunk size moves every tile, so everything has to be rebuilt.
+	 if (!bHasRenderState || layout != RenderLayout || BuiltChunkSizeInTiles != ChunkSizeInTiles) {
+		 UpdateMesh();
+		 return true;
 	 }
-	 FDynamicMesh3* renderedMesh = DynamicNavMeshRender->GetMesh();
-	 renderedMesh->Clear();
-	 renderedMesh->EnableAttributes();
-	 renderedMesh->EnableVertexUVs(FVector2f::Zero());
 	 const int tileCount = navMesh->GetNavMeshTilesCount();
-	 TArray<FNavPoly> finishedPolys;
-	 TArray<FNavPoly> currentPolys;
-	 int triA = 0; int triB = 0; int triC = 0; int currentGroup = 0;
-	 TArray<FVector> currentVerts;
-	 TArray<FVector> allVectors;
-	 /* Add Verts and Tris (During this we're checking for extremes to setup bounds that exactly match our verts and tris ) */ {
-		 for (int32 v = 0; v < tileCount; v++) {
-			 if (!navMesh->GetPolysInTile(v, currentPolys)) {
-				 continue;
-			 }
-			 for (const FNavPoly& poly : currentPolys) {
-				 if (!finishedPolys.ContainsByPredicate([poly](const FNavPoly& tester) {
-					 return poly.Center == tester.Center;
-					 })) {
-					 finishedPolys.Add(poly);
-				 }
-				 else {
-					 continue;
-				 }
-				 if (!navMesh->GetPolyVerts(poly.Ref, currentVerts)) {
-					 continue;
-				 }
-				 const float uvHeight = poly.Center.Z;
-				 for (int i = 1; i < currentVerts.Num(); i++) {
-					 triA = AssignNewVert(poly.Center, uvHeight);
-					 triB = AssignNewVert(currentVerts[i - 1], uvHeight);
-					 triC = AssignNewVert(currentVerts[i], uvHeight);
-					 renderedMesh->AppendTriangle(triA, triB, triC, currentGroup);//allVectors.Add(currentVerts[i]);
-				 }
-				 // Complete the circle
-				 triB = AssignNewVert(currentVerts[currentVerts.Num() - 1], uvHeight);
-				 triC = AssignNewVert(currentVerts[0], uvHeight);
-				 renderedMesh->AppendTriangle(triA, triB, triC, currentGroup);
+	 TArray<int32> dirtyTiles;
+	 for (int32 v = 0; v < tileCount; v++) {
+		 UDynamicNavMeshRendererComponent* const* owner = builtTiles.Find(v);
+		 const uint64 builtSignature = owner ? (*owner)->RenderState->TileSignatures.FindRef(v) : 0;
+		 if (builtSignature != NavMeshRender::GetTileSignature(*navMesh, v)) {
+			 dirtyTiles.Add(v);
+		 }
+	 }
+	 for (const TPair<int32, UDynamicNavMeshRendererComponent*>& builtTile : builtTiles) {
+		 if (builtTile.Key >= tileCount) {
+			 dirtyTiles.Add(builtTile.Key);
+		 }
+	 }
+	 if (dirtyTiles.IsEmpty()) {
+		 return true;
+	 }
+	 // Group the work by the component that owns the old tile and the one the new tile falls in.
+	 struct FChunkUpdate {
+		 TArray<int32> RemovedTiles;
+		 TArray<FNavMeshRenderTileSnapshot> Tiles;
+		 TArray<FNavMeshRenderTileBuffers> TileBuffers;
+	 };
+	 if (!TileCache.IsValid()) {
+		 TileCache = MakeShared<FNavMeshRenderTileCache>();
+	 }
+	 TileCache->SetLayout(RenderLayout);
+	 TileCache->SetMaxTiles(TileCacheSize);
+	 TMap<UDynamicNavMeshRendererComponent*, FChunkUpdate> chunkUpdates;
+	 TSet<NavNodeRef> finishedPolys;
+	 FNavMeshRenderTileSnapshot tile;
+	 FNavMeshRenderTileBuffers tileBuffers;
+	 int32 cachedTiles = 0;
+	 for (int32 tileIndex : dirtyTiles) {
+		 if (UDynamicNavMeshRendererComponent* const* owner = builtTiles.Find(tileIndex)) {
+			 chunkUpdates.FindOrAdd(*owner).RemovedTiles.Add(tileIndex);
+		 }
+		 // Tiles that streamed out and back in unchanged come from the cache instead of being gathered and triangulated again.
+		 tileBuffers.Reset();
+		 const bool bCached = TileCache->FindTile(*navMesh, tileIndex, tile, tileBuffers);
+		 cachedTiles += bCached ? 1 : 0;
+		 if (bCached || NavMeshRender::GatherTile(*navMesh, tileIndex, RenderLayout.Triangulation, finishedPolys, tile)) {
+			 UDynamicNavMeshRendererComponent* renderComponent = ChunkSizeInTiles > 0
+				 ? FindOrAddChunkComponent(NavMeshRender::GetChunkCoord(tile, ChunkSizeInTiles))
+				 : DynamicNavMeshRender.Get();
+			 FChunkUpdate& chunkUpdate = chunkUpdates.FindOrAdd(renderComponent);
+			 chunkUpdate.Tiles.Add(MoveTemp(tile));
+			 chunkUpdate.TileBuffers.Add(MoveTemp(tileBuffers));
+		 }
+	 }
+	 TArray<FNavMeshRenderTileIndex> rebuiltTileIndices;
+	 for (TPair<UDynamicNavMeshRendererComponent*, FChunkUpdate>& chunkUpdate : chunkUpdates) {
+		 UDynamicNavMeshRendererComponent* renderComponent = chunkUpdate.Key;
+		 // Chunks created above start without a mesh.
+		 if (!renderComponent->RenderState.IsValid()) {
+			 renderComponent->RenderState = MakeShared<FNavMeshRenderMeshState>();
+			 NavMeshRender::InitRenderMesh(*renderComponent->GetMesh(), RenderLayout.bPolyHighlights);
+		 }
+		 NavMeshRender::RebuildTiles(RenderLayout, chunkUpdate.Value.RemovedTiles, chunkUpdate.Value.Tiles, chunkUpdate.Value.TileBuffers, *renderComponent->GetMesh(), *renderComponent->RenderState, rebuiltTileIndices);
+		 for (int32 i = 0; i < chunkUpdate.Value.Tiles.Num(); i++) {
+			 TileCache->AddTile(chunkUpdate.Value.Tiles[i], MoveTemp(chunkUpdate.Value.TileBuffers[i]));
+		 }
+		 renderComponent->NotifyMeshUpdated();
+		 INC_DWORD_STAT(STAT_NavMeshRender_RenderStatesDirtied);
+		 RefreshRenderComponent(renderComponent);
+	 }
+	 if (ChunkSizeInTiles > 0) {
+		 TSet<FIntPoint> keepChunks;
+		 for (const TPair<FIntPoint, TObjectPtr<UDynamicNavMeshRendererComponent>>& chunk : ChunkComponents) {
+			 if (IsValid(chunk.Value) && chunk.Value->GetMesh()->TriangleCount() > 0) {
+				 keepChunks.Add(chunk.Key);
 			 }
-			 currentGroup++;
 		 }
+		 DestroyChunkComponents(keepChunks);
+	 }
+	 // Incomplete query data is rebuilt as a whole on the next query instead.
+	 if (SpatialIndex.IsValid() && SpatialIndex->IsComplete()) {
+		 for (int32 tileIndex : dirtyTiles) {
+			 SpatialIndex->RemoveTile(tileIndex);
+		 }
+		 for (FNavMeshRenderTileIndex& tileIndex : rebuiltTileIndices) {
+			 SpatialIndex->AddTile(MoveTemp(tileIndex));
+		 }
+	 }
+	 BuiltNavDataHash = GetBuiltNavDataHash();
+	 UpdateRenderStats();
+	 UpdateOutlineTiles(dirtyTiles);
+	 if (bRasterizeAtlas) {
+		 UpdateRaster();
 	 }
-	 DynamicNavMeshRender->GetDynamicMesh()->ProcessMesh([this](const FDynamicMesh3& ProcessMesh) {
+	 RefreshHighlights();
+	 UE_LOG(LogNavigation, Log, TEXT("NavMeshRenderer rebuilt %d changed tiles (%d from cache) in %d components."), dirtyTiles.Num(), cachedTiles, chunkUpdates.Num());
 	 FinishedProcessing();
-	 });
-	 DynamicNavMeshRender->UpdateBounds();
-	 // Update the material to the override variable.
-	 if (IsValid(NavMeshMaterial)) {
-		 DynamicNavMeshRender->SetMaterial(0, NavMeshMaterial);
+	 return true;
+ }
+
+ bool ANavMeshRenderer::UpdateMeshAsync() {
+	 // Streamed chunks are always built asynchronously.
+	 if (ShouldStream()) {
+		 RestartStreaming();
+		 return IsStreaming();
 	 }
-	 // This is debug info that is displayed in Details
-	 NumberOfVerts = renderedMesh->VertexCount();
-	 NumberOfTris = renderedMesh->TriangleCount();
-}
+	 if (bAsyncBuildInFlight) {
+		 bAsyncBuildPending = true;
+		 return true;
+	 }
+	 return LaunchAsyncBuild();
+ }
+
+ bool ANavMeshRenderer::IsUpdatingAsync() const {
+	 return bAsyncBuildInFlight;
+ }
 
  void ANavMeshRenderer::ClearMesh() {
+	 LatestBuildSerial++;
+	 // Streaming stops until the next update.
+	 Streaming.Reset();
+	 UpdateTickEnabled();
+	 TileCache.Reset();
+	 Raster.Reset();
+	 RasterTexture = nullptr;
+	 Highlights.Reset();
+	 HighlightTexture = nullptr;
 	 NumberOfVerts = -1;
 	 NumberOfTris = -1;
+	 BuiltNavDataHash = 0;
+	 BuiltAgentsNavDataHash = 0;
+	 SpatialIndex.Reset();
+	 BuiltSettingsHash = 0;
+	 DestroyChunkComponents(TSet<FIntPoint>());
+	 EmptyChunkComponentPool();
+	 DestroyCompactComponents(TSet<FIntPoint>());
+	 DestroyAgentComponents(TSet<FName>());
 	 if (!IsValid(DynamicNavMeshRender)) {
 		 return;
 	 }
 	 DynamicNavMeshRender->GetMesh()->Clear();
+	 DynamicNavMeshRender->RenderState.Reset();
+	 RefreshRenderComponent(DynamicNavMeshRender);
+	 RebuildOutline();
+	 UpdateMemoryStats();
 	 FinishedProcessing();
  }
 
  void ANavMeshRenderer::z_SaveMesh() {
 #if WITH_EDITOR
-	if (!IsValid(DynamicNavMeshRender) || !IsValid(DynamicNavMeshRender->GetDynamicMesh())) {
-		UE_LOG(LogNavigation, Error, TEXT("Unable to save. No NavMeshRender."));
-		return;
-	}
-	if (DynamicNavMeshRender->GetMesh()->TriangleCount() <= 0) {
-		UE_LOG(LogNavigation, Error, TEXT("Unable to save. Render has no Tris."));
-		return;
-	}
 	if (FPackageName::DoesPackageNameContainInvalidCharacters(SaveName) || SaveName.IsEmpty()) {
 		UE_LOG(LogNavigation, Error, TEXT("Unable to save. Invalid Asset Name: %s"), *SaveName);
 		return;
@@ -218,12 +566,34 @@ FVector2D ANavMeshRenderer::GetUV_Coordinate(const FVector& location, float cent
 		UE_LOG(LogNavigation, Error, TEXT("Unable to save. Invalid Package Name: %s"), *packageName);
 		return;
 	}
+	SaveMeshAsset(packageName);
+	return;
+#endif
+	 UE_LOG(LogNavigation, Warning, TEXT("NavMeshRenderer cannot save during runtime"));
+ }
+
+ UStaticMesh* ANavMeshRenderer::SaveMeshAsset(const FString& packageName) {
+#if WITH_EDITOR
+	if (!IsValid(DynamicNavMeshRender) || !IsValid(DynamicNavMeshRender->GetDynamicMesh())) {
+		UE_LOG(LogNavigation, Error, TEXT("Unable to save. No NavMeshRender."));
+		return nullptr;
+	}
+	FDynamicMesh3 renderedMesh;
+	CopyRenderedMesh(renderedMesh);
+	if (renderedMesh.TriangleCount() <= 0) {
+		UE_LOG(LogNavigation, Error, TEXT("Unable to save. Render has no Tris."));
+		return nullptr;
+	}
 	FCreateMeshObjectParams creationParams;
 	DynamicNavMeshRender->ValidateMaterialSlots();
 	for (UMaterialInterface* mat : DynamicNavMeshRender->GetMaterials()) {
+		// ParameterMaterial is a transient instance holding the area mask, packed floor and highlight parameters. The asset gets the material it was made from.
+		if (UMaterialInstanceDynamic* parameterMaterial = Cast<UMaterialInstanceDynamic>(mat)) {
+			mat = parameterMaterial->Parent;
+		}
 		creationParams.Materials.Add(mat);
 	}
-	creationParams.SetMesh(DynamicNavMeshRender->GetMesh());
+	creationParams.SetMesh(&renderedMesh);
 	creationParams.MeshType = ECreateMeshObjectSourceMeshType::DynamicMesh;
 	creationParams.BaseName = packageName;
 	creationParams.TargetWorld = nullptr;
@@ -244,86 +614,1339 @@ FVector2D ANavMeshRenderer::GetUV_Coordinate(const FVector& location, float cent
 	UE::AssetUtils::ECreateStaticMeshResult creationResult = UE::AssetUtils::CreateStaticMeshAsset(creationOptions, result);
 	if (creationResult == UE::AssetUtils::ECreateStaticMeshResult::Ok) {
 		UE_LOG(LogNavigation, Warning, TEXT("Successfully copied to Static Mesh Asset."));
+		return result.StaticMesh;
 	}
-	else {
-		UE_LOG(LogNavigation, Error, TEXT("Failed to copy to Static Mesh Asset."));
-	}
-	return;
+	UE_LOG(LogNavigation, Error, TEXT("Failed to copy to Static Mesh Asset."));
+	return nullptr;
+#else
+	 return nullptr;
 #endif
-	 UE_LOG(LogNavigation, Warning, TEXT("NavMeshRenderer cannot save during runtime"));
  }
 
- int ANavMeshRenderer::AssignNewVert(const FVector& location, float UVHeight) {
-	 UE::Geometry::FVertexInfo info;
-	 info.Position = location + FVector(0.f, 0.f, ZOffset);
-	 info.bHaveUV = true;
-	 info.bHaveN = true;
-	 info.bHaveC = true;
-	 info.UV = UVCoord(location, UVHeight);
-	 info.Normal = FVector3f::UpVector;
-	 info.Color = FVector3f();
-	 if (!IsValid(DynamicNavMeshRender)) {
-		 UE_LOG(LogNavigation, Warning, TEXT("NavMeshRenderer does not have a Dynamic Mesh Component"));
-		 return - 1;
+ uint32 ANavMeshRenderer::GetNavMeshRenderHash() const {
+	 const ARecastNavMesh* navMesh = GetNavMesh();
+	 if (!IsValid(navMesh)) {
+		 return 0;
+	 }
+	 uint32 retVal = HashCombine(GetSettingsHash(*navMesh), NavMeshRender::GetNavDataHash(*navMesh));
+	 if (const uint32 agentsHash = GetAgentsNavDataHash()) {
+		 retVal = HashCombine(retVal, agentsHash);
 	 }
-	 FDynamicMesh3* renderedMesh = DynamicNavMeshRender->GetMesh();
-	 
-	 int retVal = renderedMesh->AppendVertex(info);
 	 return retVal;
  }
 
- FVector2f ANavMeshRenderer::UVCoord(const FVector& location, float centralHeight) const {
-	 FVector2f retVal;
-	 const FVector relativeLocation = location - NavMeshCorner;
-	 const float relativeCentralHeight = centralHeight - NavMeshCorner.Z;
-	 int floor = 0;
-	 for (float floorHeight : AdditionalFloorHeights) {
-		 if (relativeCentralHeight >= floorHeight) {
-			 floor++;
-		 }
-	 }
-	 const float floorX = floor % FloorRowSize;
-	 const float floorY = FMath::TruncToInt((float)floor / (float)FloorRowSize);
-	 // retVal is not the correct uv position if the floor takes up the entire UV
-	 retVal = FVector2f((relativeLocation.X / NavMeshSize.X) * (1 - UV_IslandMargins), 
-		 (relativeLocation.Y / NavMeshSize.Y) * (1 - UV_IslandMargins));
-	 // positions retVal to accomodate multiple floors in the UV
-	 if (NumberOfFloors > 1){
-		 retVal = FVector2f(
-			 (retVal.X / (float)FloorRowSize) + (floorX / (float)FloorRowSize) + (floorX * UV_IslandMargins),
-			 (retVal.Y / (float)FloorRowSize) + (floorY / (float)FloorRowSize) + (floorY * UV_IslandMargins)
-		 );
-	 }
-	 
+ const ARecastNavMesh* ANavMeshRenderer::PrepareBuild(FNavMeshRenderLayout& outLayout) {
+	 if (!IsValid(DynamicNavMeshRender)) {
+		 DynamicNavMeshRender = CreateDefaultSubobject<UDynamicNavMeshRendererComponent>(TEXT("NavMeshRender"));
+		 if (IsValid(DynamicNavMeshRender)) {
+			 DynamicNavMeshRender->SetupAttachment(GetRootComponent());
+			 if (NumberOfTris > 0) {
+				 if (IsValid(NavMeshMaterial)) {
+					 DynamicNavMeshRender->SetMaterial(0, NavMeshMaterial);
+				 }
+			 }
+		 }
+	 }
+	 const ARecastNavMesh* navMesh = GetNavMesh();
+	 if (!IsValid(navMesh)) {
+		 UE_LOG(LogNavigation, Warning, TEXT("NavMeshRenderer found no Navigation Mesh"));
+		 return nullptr;
+	 }
+	 AdditionalFloorHeights.Sort();
+	 outLayout = MakeRenderLayout(*navMesh);
+	 return navMesh;
+ }
+
+ FNavMeshRenderLayout ANavMeshRenderer::MakeRenderLayout(const ARecastNavMesh& navMesh) const {
+	 FNavMeshRenderLayout retVal;
+	 retVal.NavMeshSize = navMesh.GetBounds().GetSize();
+	 retVal.NavMeshCorner = navMesh.GetBounds().GetCenter() - retVal.NavMeshSize / 2;
+	 retVal.AdditionalFloorHeights = AdditionalFloorHeights;
+	 // GetFloor binary searches the heights.
+	 retVal.AdditionalFloorHeights.Sort();
+	 retVal.NumberOfFloors = 1;
+	 for (float floorHeight : retVal.AdditionalFloorHeights) {
+		 if (floorHeight <= retVal.NavMeshSize.Z && floorHeight > 0) {
+			 retVal.NumberOfFloors++;
+		 }
+	 }
+	 retVal.FloorRowSize = 1;
+	 if (retVal.NumberOfFloors > 1) {
+		 retVal.FloorRowSize = sqrt(retVal.NumberOfFloors) + 1;
+	 }
+	 retVal.UV_IslandMargins = UV_IslandMargins;
+	 retVal.ZOffset = ZOffset;
+	 retVal.Triangulation = Triangulation;
+	 retVal.bPolyHighlights = bPolyHighlights && !bCompactRender;
+	 if (retVal.bPolyHighlights) {
+		 retVal.HighlightTileStride = NavMeshRender::GetHighlightTileStride(navMesh);
+	 }
+	 if (bPackFloorUVs) {
+		 PackFloorUVs(navMesh, retVal);
+	 }
 	 return retVal;
  }
 
- const ARecastNavMesh* ANavMeshRenderer::GetNavMesh() const {
-	 if (!IsValid(GetWorld())) {
-		 UE_LOG(LogNavigation, Warning, TEXT("NavMeshRenderer found no World"));
+ void ANavMeshRenderer::CommitRenderLayout(const FNavMeshRenderLayout& layout) {
+	 NavMeshCorner = layout.NavMeshCorner;
+	 NavMeshSize = layout.NavMeshSize;
+	 NumberOfFloors = layout.NumberOfFloors;
+	 FloorRowSize = layout.FloorRowSize;
+	 FloorUVTransforms = layout.FloorUVTransforms;
+	 HighlightTileStride = layout.HighlightTileStride;
+	 RenderLayout = layout;
+	 if (IsValid(DynamicNavMeshRender)) {
+		 DynamicNavMeshRender->BoundsExtents = NavMeshSize;
+		 DynamicNavMeshRender->UpdateBounds();
+	 }
+	 // The floor transforms the material reads change with the floors and bounds whether or not they are packed.
+	 ApplyMaterialParameters();
+ }
+
+ bool ANavMeshRenderer::SnapshotNavMesh(TArray<FNavMeshRenderTileSnapshot>& outTiles, uint32& outSettingsHash, FNavMeshRenderLayout& outLayout) {
+	 const ARecastNavMesh* navMesh = PrepareBuild(outLayout);
+	 if (!IsValid(navMesh)) {
+		 return false;
+	 }
+	 outSettingsHash = GetSettingsHash(*navMesh);
+	 NavMeshRender::GatherTiles(*navMesh, outLayout.Triangulation, outTiles);
+	 return true;
+ }
+
+ void ANavMeshRenderer::ApplyBuiltChunks(const FNavMeshRenderLayout& layout, TArray<FNavMeshRenderChunk>&& builtChunks, TArray<FNavMeshRenderAgentBuild>&& agentBuilds, int chunkSizeInTiles, uint32 settingsHash) {
+	 NAVMESHRENDER_SCOPE_CYCLE_COUNTER(STAT_NavMeshRender_ApplyChunks);
+	 if (!IsValid(DynamicNavMeshRender)) {
+		 return;
+	 }
+	 // The old render was shown and queried with the old layout up to here.
+	 CommitRenderLayout(layout);
+	 BuiltChunkSizeInTiles = chunkSizeInTiles;
+	 BuiltSettingsHash = settingsHash;
+	 ApplyBuiltAgents(MoveTemp(agentBuilds));
+	 ApplyBuiltSpatialIndex(builtChunks);
+	 TSet<FIntPoint> builtCoords;
+	 if (bCompactRender) {
+		 // Only the compact components keep the render. The main component is left empty and without state,
+		 // which makes UpdateChangedTiles fall back to a full rebuild.
+		 FDynamicMesh3 emptyMesh;
+		 NavMeshRender::InitRenderMesh(emptyMesh);
+		 DynamicNavMeshRender->SetMesh(MoveTemp(emptyMesh));
+		 DynamicNavMeshRender->RenderState.Reset();
+		 RefreshRenderComponent(DynamicNavMeshRender);
+		 uint32 navDataHash = 0;
+		 TSet<FIntPoint> compactCoords;
+		 for (FNavMeshRenderChunk& chunk : builtChunks) {
+			 UNavMeshCompactRenderComponent* compactComponent = FindOrAddCompactComponent(chunk.Coord);
+			 compactComponent->SetMesh(chunk.Mesh, RenderLayout.GetQuantizeGrid());
+			 // Free each full mesh as soon as it has been compacted, so only one chunk is held twice at a time.
+			 chunk.Mesh = FDynamicMesh3();
+			 RefreshCompactComponent(compactComponent);
+			 navDataHash ^= NavMeshRender::GetNavDataHash(*chunk.State);
+			 compactCoords.Add(chunk.Coord);
+		 }
+		 builtChunks.Empty();
+		 DestroyChunkComponents(builtCoords);
+		 DestroyCompactComponents(compactCoords);
+		 BuiltNavDataHash = navDataHash;
+		 UpdateRenderStats();
+		 RebuildOutline();
+		 if (bRasterizeAtlas) {
+			 UpdateRaster();
+		 }
+		 RefreshHighlights();
+		 FinishedProcessing();
+		 return;
+	 }
+	 DestroyCompactComponents(TSet<FIntPoint>());
+	 if (chunkSizeInTiles <= 0) {
+		 FDynamicMesh3 builtMesh;
+		 TSharedPtr<FNavMeshRenderMeshState> builtState = MakeShared<FNavMeshRenderMeshState>();
+		 if (builtChunks.Num() > 0) {
+			 builtMesh = MoveTemp(builtChunks[0].Mesh);
+			 builtState = builtChunks[0].State;
+		 }
+		 else {
+			 NavMeshRender::InitRenderMesh(builtMesh, RenderLayout.bPolyHighlights);
+		 }
+		 DynamicNavMeshRender->SetMesh(MoveTemp(builtMesh));
+		 DynamicNavMeshRender->RenderState = builtState;
+		 RefreshRenderComponent(DynamicNavMeshRender);
+	 }
+	 else {
+		 // The main component is left empty while chunked.
+		 FDynamicMesh3 emptyMesh;
+		 NavMeshRender::InitRenderMesh(emptyMesh);
+		 DynamicNavMeshRender->SetMesh(MoveTemp(emptyMesh));
+		 DynamicNavMeshRender->RenderState = MakeShared<FNavMeshRenderMeshState>();
+		 RefreshRenderComponent(DynamicNavMeshRender);
+		 for (FNavMeshRenderChunk& chunk : builtChunks) {
+			 UDynamicNavMeshRendererComponent* chunkComponent = FindOrAddChunkComponent(chunk.Coord);
+			 chunkComponent->SetMesh(MoveTemp(chunk.Mesh));
+			 chunkComponent->RenderState = chunk.State;
+			 RefreshRenderComponent(chunkComponent);
+			 builtCoords.Add(chunk.Coord);
+		 }
+	 }
+	 DestroyChunkComponents(builtCoords);
+	 BuiltNavDataHash = GetBuiltNavDataHash();
+	 UpdateRenderStats();
+	 RebuildOutline();
+	 if (bRasterizeAtlas) {
+		 UpdateRaster();
+	 }
+	 RefreshHighlights();
+	 FinishedProcessing();
+ }
+
+ void ANavMeshRenderer::ApplyBuiltSpatialIndex(TArray<FNavMeshRenderChunk>& builtChunks) {
+	 if (!SpatialIndex.IsValid()) {
+		 SpatialIndex = MakeShared<FNavMeshRenderSpatialIndex>();
+	 }
+	 SpatialIndex->Reset();
+	 for (FNavMeshRenderChunk& chunk : builtChunks) {
+		 for (FNavMeshRenderTileIndex& tileIndex : chunk.TileIndices) {
+			 SpatialIndex->AddTile(MoveTemp(tileIndex));
+		 }
+		 chunk.TileIndices.Empty();
+	 }
+	 SpatialIndex->MarkComplete();
+ }
+
+ const FNavMeshRenderSpatialIndex* ANavMeshRenderer::EnsureSpatialIndex() {
+	 if (SpatialIndex.IsValid() && SpatialIndex->IsComplete()) {
+		 return SpatialIndex.Get();
+	 }
+	 // Nothing rendered, nothing to query.
+	 if (NumberOfTris <= 0) {
 		 return nullptr;
 	 }
-	 if (!IsValid(GetWorld()->GetNavigationSystem())) {
-		 UE_LOG(LogNavigation, Warning, TEXT("NavMeshRenderer found no Navigation System"));
+	 const ARecastNavMesh* navMesh = GetNavMesh();
+	 if (!IsValid(navMesh)) {
 		 return nullptr;
 	 }
-	 return Cast<ARecastNavMesh>(GetWorld()->GetNavigationSystem()->GetMainNavData());	 
+	 NAVMESHRENDER_SCOPE_CYCLE_COUNTER(STAT_NavMeshRender_RebuildSpatialIndex);
+	 TArray<FNavMeshRenderTileSnapshot> tiles;
+	 NavMeshRender::GatherTiles(*navMesh, RenderLayout.Triangulation, tiles);
+	 TArray<FNavMeshRenderTileIndex> tileIndices;
+	 NavMeshRender::BuildTileIndices(RenderLayout, tiles, tileIndices);
+	 if (!SpatialIndex.IsValid()) {
+		 SpatialIndex = MakeShared<FNavMeshRenderSpatialIndex>();
+	 }
+	 SpatialIndex->Reset();
+	 for (FNavMeshRenderTileIndex& tileIndex : tileIndices) {
+		 SpatialIndex->AddTile(MoveTemp(tileIndex));
+	 }
+	 SpatialIndex->MarkComplete();
+	 UpdateMemoryStats();
+	 return SpatialIndex.Get();
  }
 
- void ANavMeshRenderer::FinishedProcessing() {
-	 UE_LOG(LogNavigation, Warning, TEXT("NavMeshRenderer Finished processing mesh."));
-	 UE::Geometry::CopyVertexUVsToOverlay(*DynamicNavMeshRender->GetMesh(), *DynamicNavMeshRender->GetMesh()->Attributes()->PrimaryUV());
-	 //DynamicNavMeshRender->GetMesh()->Attributes()->EnableTangents();
-	 DynamicNavMeshRender->UpdateBounds();
-	 DynamicNavMeshRender->MarkRenderStateDirty();
-#if WITH_EDITOR
-	 DynamicNavMeshRender->MarkPackageDirty();
-	 DynamicNavMeshRender->GetDynamicMesh()->MarkPackageDirty();
-#endif
+ TArray<UDynamicNavMeshRendererComponent*> ANavMeshRenderer::GetRenderComponents() const {
+	 TArray<UDynamicNavMeshRendererComponent*> retVal;
+	 if (IsValid(DynamicNavMeshRender)) {
+		 retVal.Add(DynamicNavMeshRender);
+	 }
+	 for (const TPair<FIntPoint, TObjectPtr<UDynamicNavMeshRendererComponent>>& chunk : ChunkComponents) {
+		 if (IsValid(chunk.Value)) {
+			 retVal.Add(chunk.Value);
+		 }
+	 }
+	 return retVal;
+ }
+
+ UDynamicNavMeshRendererComponent* ANavMeshRenderer::FindOrAddChunkComponent(const FIntPoint& chunkCoord) {
+	 if (const TObjectPtr<UDynamicNavMeshRendererComponent>* existing = ChunkComponents.Find(chunkCoord)) {
+		 if (IsValid(*existing)) {
+			 return *existing;
+		 }
+	 }
+	 // Pooled components are already registered, which is far cheaper than creating one.
+	 while (!ChunkComponentPool.IsEmpty()) {
+		 UDynamicNavMeshRendererComponent* pooled = ChunkComponentPool.Pop();
+		 if (IsValid(pooled)) {
+			 pooled->SetVisibility(true);
+			 ChunkComponents.Add(chunkCoord, pooled);
+			 return pooled;
+		 }
+	 }
+	 const FName chunkName = MakeUniqueObjectName(this, UDynamicNavMeshRendererComponent::StaticClass(),
+		 *FString::Printf(TEXT("NavMeshRenderChunk_%d_%d"), chunkCoord.X, chunkCoord.Y));
+	 UDynamicNavMeshRendererComponent* retVal = NewObject<UDynamicNavMeshRendererComponent>(this, chunkName);
+	 retVal->bUseNavMeshBounds = false;
+	 retVal->SetupAttachment(GetRootComponent());
+	 retVal->RegisterComponent();
+	 AddInstanceComponent(retVal);
+	 ChunkComponents.Add(chunkCoord, retVal);
+	 return retVal;
+ }
+
+ void ANavMeshRenderer::DestroyChunkComponents(const TSet<FIntPoint>& keepChunks) {
+	 for (auto it = ChunkComponents.CreateIterator(); it; ++it) {
+		 if (keepChunks.Contains(it.Key()) && IsValid(it.Value())) {
+			 continue;
+		 }
+		 if (IsValid(it.Value())) {
+			 RemoveInstanceComponent(it.Value());
+			 it.Value()->DestroyComponent();
+		 }
+		 it.RemoveCurrent();
+	 }
+ }
+
+ void ANavMeshRenderer::ReleaseChunkComponent(const FIntPoint& chunkCoord) {
+	 TObjectPtr<UDynamicNavMeshRendererComponent> chunkComponent;
+	 if (!ChunkComponents.RemoveAndCopyValue(chunkCoord, chunkComponent) || !IsValid(chunkComponent)) {
+		 return;
+	 }
+	 if (ChunkComponentPool.Num() >= StreamingPoolSize) {
+		 RemoveInstanceComponent(chunkComponent);
+		 chunkComponent->DestroyComponent();
+		 return;
+	 }
+	 // Emptied so pooled components hold no mesh memory.
+	 chunkComponent->GetMesh()->Clear();
+	 chunkComponent->RenderState.Reset();
+	 chunkComponent->SetVisibility(false);
+	 chunkComponent->MarkRenderStateDirty();
+	 INC_DWORD_STAT(STAT_NavMeshRender_RenderStatesDirtied);
+	 ChunkComponentPool.Add(chunkComponent);
+ }
+
+ void ANavMeshRenderer::EmptyChunkComponentPool() {
+	 for (UDynamicNavMeshRendererComponent* pooled : ChunkComponentPool) {
+		 if (IsValid(pooled)) {
+			 RemoveInstanceComponent(pooled);
+			 pooled->DestroyComponent();
+		 }
+	 }
+	 ChunkComponentPool.Empty();
+ }
+
+ void ANavMeshRenderer::RefreshRenderComponent(UDynamicNavMeshRendererComponent* renderComponent) {
+	 // Update the material to the override variable.
+	 if (IsValid(GetRenderMaterial())) {
+		 renderComponent->SetMaterial(0, GetRenderMaterial());
+	 }
+	 if (renderComponent != DynamicNavMeshRender) {
+		 renderComponent->SetCullDistance(ChunkCullDistance);
+	 }
+	 renderComponent->UpdateBounds();
+	 renderComponent->MarkRenderStateDirty();
+	 INC_DWORD_STAT(STAT_NavMeshRender_RenderStatesDirtied);
+#if WITH_EDITOR
+	 renderComponent->MarkPackageDirty();
+	 renderComponent->GetDynamicMesh()->MarkPackageDirty();
+#endif
+ }
+
+ UNavMeshCompactRenderComponent* ANavMeshRenderer::FindOrAddCompactComponent(const FIntPoint& chunkCoord) {
+	 if (const TObjectPtr<UNavMeshCompactRenderComponent>* existing = CompactComponents.Find(chunkCoord)) {
+		 if (IsValid(*existing)) {
+			 return *existing;
+		 }
+	 }
+	 const FName chunkName = MakeUniqueObjectName(this, UNavMeshCompactRenderComponent::StaticClass(),
+		 *FString::Printf(TEXT("NavMeshCompactRender_%d_%d"), chunkCoord.X, chunkCoord.Y));
+	 UNavMeshCompactRenderComponent* retVal = NewObject<UNavMeshCompactRenderComponent>(this, chunkName);
+	 retVal->SetupAttachment(GetRootComponent());
+	 retVal->RegisterComponent();
+	 AddInstanceComponent(retVal);
+	 CompactComponents.Add(chunkCoord, retVal);
+	 return retVal;
+ }
+
+ void ANavMeshRenderer::DestroyCompactComponents(const TSet<FIntPoint>& keepChunks) {
+	 for (auto it = CompactComponents.CreateIterator(); it; ++it) {
+		 if (keepChunks.Contains(it.Key()) && IsValid(it.Value())) {
+			 continue;
+		 }
+		 if (IsValid(it.Value())) {
+			 RemoveInstanceComponent(it.Value());
+			 it.Value()->DestroyComponent();
+		 }
+		 it.RemoveCurrent();
+	 }
+ }
+
+ void ANavMeshRenderer::RefreshCompactComponent(UNavMeshCompactRenderComponent* compactComponent) {
+	 if (IsValid(GetRenderMaterial())) {
+		 compactComponent->SetMaterial(0, GetRenderMaterial());
+	 }
+	 compactComponent->SetCullDistance(ChunkSizeInTiles > 0 ? ChunkCullDistance : 0.f);
+	 compactComponent->MarkRenderStateDirty();
+	 INC_DWORD_STAT(STAT_NavMeshRender_RenderStatesDirtied);
+#if WITH_EDITOR
+	 compactComponent->MarkPackageDirty();
+#endif
+ }
+
+ uint32 ANavMeshRenderer::GetBuiltAgentsNavDataHash() const {
+	 uint32 retVal = 0;
+	 TSet<FName> hashedAgents;
+	 for (const FNavMeshRenderAgent& agent : Agents) {
+		 const TObjectPtr<UDynamicNavMeshRendererComponent>* agentComponent = AgentComponents.Find(agent.AgentName);
+		 if (!agentComponent || !IsValid(*agentComponent) || !(*agentComponent)->RenderState.IsValid() || hashedAgents.Contains(agent.AgentName)) {
+			 continue;
+		 }
+		 hashedAgents.Add(agent.AgentName);
+		 retVal = HashCombine(retVal, HashCombine(GetTypeHash(agent.AgentName), NavMeshRender::GetNavDataHash(*(*agentComponent)->RenderState)));
+	 }
+	 return retVal;
+ }
+
+ uint32 ANavMeshRenderer::GetAgentsNavDataHash() const {
+	 uint32 retVal = 0;
+	 for (const TPair<FName, const ARecastNavMesh*>& agentNavMesh : GetAgentNavMeshes()) {
+		 retVal = HashCombine(retVal, HashCombine(GetTypeHash(agentNavMesh.Key), NavMeshRender::GetNavDataHash(*agentNavMesh.Value)));
+	 }
+	 return retVal;
+ }
+
+ TArray<TPair<FName, const ARecastNavMesh*>> ANavMeshRenderer::GetAgentNavMeshes() const {
+	 TArray<TPair<FName, const ARecastNavMesh*>> retVal;
+	 if (Agents.IsEmpty() || !IsValid(GetWorld())) {
+		 return retVal;
+	 }
+	 const ARecastNavMesh* mainNavMesh = GetNavMesh();
+	 const UNavigationSystemV1* navSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	 TSet<FName> addedAgents;
+	 for (const FNavMeshRenderAgent& agent : Agents) {
+		 if (agent.AgentName.IsNone() || addedAgents.Contains(agent.AgentName)) {
+			 continue;
+		 }
+		 const ARecastNavMesh* agentNavMesh = IsValid(navSys) ? Cast<ARecastNavMesh>(navSys->GetNavDataForAgentName(agent.AgentName)) : nullptr;
+		 // Same fallback as GetNavMesh for worlds without registered nav data.
+		 if (!IsValid(agentNavMesh)) {
+			 for (TActorIterator<ARecastNavMesh> it(GetWorld()); it; ++it) {
+				 if (it->GetConfig().Name == agent.AgentName) {
+					 agentNavMesh = *it;
+					 break;
+				 }
+			 }
+		 }
+		 if (!IsValid(agentNavMesh) || agentNavMesh == mainNavMesh) {
+			 continue;
+		 }
+		 addedAgents.Add(agent.AgentName);
+		 retVal.Emplace(agent.AgentName, agentNavMesh);
+	 }
+	 return retVal;
+ }
+
+ void ANavMeshRenderer::SnapshotAgents(ENavMeshRenderTriangulation triangulation, TArray<FNavMeshRenderAgentBuild>& outAgentBuilds) const {
+	 outAgentBuilds.Reset();
+	 for (const TPair<FName, const ARecastNavMesh*>& agentNavMesh : GetAgentNavMeshes()) {
+		 FNavMeshRenderAgentBuild& agentBuild = outAgentBuilds.AddDefaulted_GetRef();
+		 agentBuild.AgentName = agentNavMesh.Key;
+		 NavMeshRender::GatherTiles(*agentNavMesh.Value, triangulation, agentBuild.Tiles);
+	 }
+ }
+
+ void ANavMeshRenderer::ApplyBuiltAgents(TArray<FNavMeshRenderAgentBuild>&& agentBuilds) {
+	 TSet<FName> builtAgents;
+	 for (FNavMeshRenderAgentBuild& agentBuild : agentBuilds) {
+		 UDynamicNavMeshRendererComponent* agentComponent = FindOrAddAgentComponent(agentBuild.AgentName);
+		 agentComponent->SetMesh(MoveTemp(agentBuild.Mesh));
+		 agentComponent->RenderState = agentBuild.State;
+		 agentComponent->UpdateBounds();
+		 agentComponent->MarkRenderStateDirty();
+		 INC_DWORD_STAT(STAT_NavMeshRender_RenderStatesDirtied);
+#if WITH_EDITOR
+		 agentComponent->MarkPackageDirty();
+		 agentComponent->GetDynamicMesh()->MarkPackageDirty();
+#endif
+		 builtAgents.Add(agentBuild.AgentName);
+	 }
+	 DestroyAgentComponents(builtAgents);
+	 RefreshAgentComponents();
+	 BuiltAgentsNavDataHash = GetBuiltAgentsNavDataHash();
+ }
+
+ void ANavMeshRenderer::UpdateAgentMeshes() {
+	 TArray<FNavMeshRenderAgentBuild> agentBuilds;
+	 SnapshotAgents(RenderLayout.Triangulation, agentBuilds);
+	 NavMeshRender::BuildAgentMeshes(RenderLayout, agentBuilds);
+	 ApplyBuiltAgents(MoveTemp(agentBuilds));
+	 UpdateRenderStats();
+	 FinishedProcessing();
+ }
+
+ UDynamicNavMeshRendererComponent* ANavMeshRenderer::FindOrAddAgentComponent(FName agentName) {
+	 if (const TObjectPtr<UDynamicNavMeshRendererComponent>* existing = AgentComponents.Find(agentName)) {
+		 if (IsValid(*existing)) {
+			 return *existing;
+		 }
+	 }
+	 const FName componentName = MakeUniqueObjectName(this, UDynamicNavMeshRendererComponent::StaticClass(),
+		 *FString::Printf(TEXT("NavMeshRenderAgent_%s"), *agentName.ToString()));
+	 UDynamicNavMeshRendererComponent* retVal = NewObject<UDynamicNavMeshRendererComponent>(this, componentName);
+	 retVal->bUseNavMeshBounds = false;
+	 retVal->SetupAttachment(GetRootComponent());
+	 retVal->RegisterComponent();
+	 AddInstanceComponent(retVal);
+	 AgentComponents.Add(agentName, retVal);
+	 return retVal;
+ }
+
+ void ANavMeshRenderer::DestroyAgentComponents(const TSet<FName>& keepAgents) {
+	 for (auto it = AgentComponents.CreateIterator(); it; ++it) {
+		 if (keepAgents.Contains(it.Key()) && IsValid(it.Value())) {
+			 continue;
+		 }
+		 if (IsValid(it.Value())) {
+			 RemoveInstanceComponent(it.Value());
+			 it.Value()->DestroyComponent();
+		 }
+		 it.RemoveCurrent();
+	 }
+ }
+
+ void ANavMeshRenderer::RefreshAgentComponent(UDynamicNavMeshRendererComponent* agentComponent, const FNavMeshRenderAgent& agent) {
+	 UMaterialInterface* material = IsValid(agent.Material) ? agent.Material.Get() : GetRenderMaterial();
+	 if (IsValid(material) && agentComponent->GetMaterial(0) != material) {
+		 agentComponent->SetMaterial(0, material);
+	 }
+	 agentComponent->SetVisibility(agent.bVisible);
+ }
+
+ void ANavMeshRenderer::RefreshAgentComponents() {
+	 for (const FNavMeshRenderAgent& agent : Agents) {
+		 const TObjectPtr<UDynamicNavMeshRendererComponent>* agentComponent = AgentComponents.Find(agent.AgentName);
+		 if (agentComponent && IsValid(*agentComponent)) {
+			 RefreshAgentComponent(*agentComponent, agent);
+		 }
+	 }
+ }
+
+ uint32 ANavMeshRenderer::GetSettingsHash(const ARecastNavMesh& navMesh) const {
+	 TArray<float> sortedFloorHeights = AdditionalFloorHeights;
+	 sortedFloorHeights.Sort();
+	 const FBox navBounds = navMesh.GetBounds();
+	 uint32 retVal = FCrc::MemCrc32(sortedFloorHeights.GetData(), sortedFloorHeights.Num() * sizeof(float));
+	 retVal = FCrc::MemCrc32(&navBounds.Min, sizeof(FVector), retVal);
+	 retVal = FCrc::MemCrc32(&navBounds.Max, sizeof(FVector), retVal);
+	 retVal = HashCombine(retVal, ::GetTypeHash(ZOffset));
+	 retVal = HashCombine(retVal, ::GetTypeHash(UV_IslandMargins));
+	 retVal = HashCombine(retVal, ::GetTypeHash(bPackFloorUVs));
+	 retVal = HashCombine(retVal, ::GetTypeHash(ChunkSizeInTiles));
+	 retVal = HashCombine(retVal, ::GetTypeHash((uint8)Triangulation));
+	 retVal = HashCombine(retVal, ::GetTypeHash(bCompactRender));
+	 retVal = HashCombine(retVal, ::GetTypeHash(bPolyHighlights));
+	 retVal = HashCombine(retVal, NavMeshRender::MeshFormatVersion);
+	 // Material and visibility are left out since they don't need a rebuild.
+	 for (const FNavMeshRenderAgent& agent : Agents) {
+		 retVal = HashCombine(retVal, GetTypeHash(agent.AgentName));
+	 }
+	 return retVal;
+ }
+
+ uint32 ANavMeshRenderer::GetBuiltNavDataHash() const {
+	 uint32 retVal = 0;
+	 for (UDynamicNavMeshRendererComponent* renderComponent : GetRenderComponents()) {
+		 if (!renderComponent->RenderState.IsValid()) {
+			 continue;
+		 }
+		 retVal ^= NavMeshRender::GetNavDataHash(*renderComponent->RenderState);
+	 }
+	 return retVal;
+ }
+
+ void ANavMeshRenderer::UpdateRenderStats() {
+	 // This is debug info that is displayed in Details
+	 NumberOfVerts = 0;
+	 NumberOfTris = 0;
+	 for (UDynamicNavMeshRendererComponent* renderComponent : GetRenderComponents()) {
+		 NumberOfVerts += renderComponent->GetMesh()->VertexCount();
+		 NumberOfTris += renderComponent->GetMesh()->TriangleCount();
+	 }
+	 for (const TPair<FIntPoint, TObjectPtr<UNavMeshCompactRenderComponent>>& compactChunk : CompactComponents) {
+		 if (IsValid(compactChunk.Value)) {
+			 NumberOfVerts += compactChunk.Value->GetNumVertices();
+			 NumberOfTris += compactChunk.Value->GetNumTriangles();
+		 }
+	 }
+	 for (const TPair<FName, TObjectPtr<UDynamicNavMeshRendererComponent>>& agentComponent : AgentComponents) {
+		 if (IsValid(agentComponent.Value)) {
+			 NumberOfVerts += agentComponent.Value->GetMesh()->VertexCount();
+			 NumberOfTris += agentComponent.Value->GetMesh()->TriangleCount();
+		 }
+	 }
+	 UpdateMemoryStats();
+ }
+
+ void ANavMeshRenderer::UpdateMemoryStats() {
+	 SIZE_T dynamicMeshBytes = 0;
+	 SIZE_T compactMeshBytes = 0;
+	 for (UDynamicNavMeshRendererComponent* renderComponent : GetRenderComponents()) {
+		 dynamicMeshBytes += renderComponent->GetMesh()->GetByteCount();
+	 }
+	 for (const TPair<FName, TObjectPtr<UDynamicNavMeshRendererComponent>>& agentComponent : AgentComponents) {
+		 if (IsValid(agentComponent.Value)) {
+			 dynamicMeshBytes += agentComponent.Value->GetMesh()->GetByteCount();
+		 }
+	 }
+	 for (const TPair<FIntPoint, TObjectPtr<UNavMeshCompactRenderComponent>>& compactChunk : CompactComponents) {
+		 if (IsValid(compactChunk.Value)) {
+			 compactMeshBytes += compactChunk.Value->GetDataSize();
+		 }
+	 }
+	 SetMemoryStats(dynamicMeshBytes, compactMeshBytes, SpatialIndex.IsValid() ? SpatialIndex->GetAllocatedSize() : 0, TileCache.IsValid() ? TileCache->GetAllocatedSize() : 0,
+		 Raster.IsValid() ? Raster->GetAllocatedSize() : 0);
+ }
+
+ void ANavMeshRenderer::SetMemoryStats(SIZE_T dynamicMeshBytes, SIZE_T compactMeshBytes, SIZE_T spatialIndexBytes, SIZE_T tileCacheBytes, SIZE_T rasterBytes) {
+	 // Stats are shared by every renderer, so only this renderer's change is applied.
+	 DEC_MEMORY_STAT_BY(STAT_NavMeshRender_DynamicMeshMemory, ReportedDynamicMeshBytes);
+	 DEC_MEMORY_STAT_BY(STAT_NavMeshRender_CompactMeshMemory, ReportedCompactMeshBytes);
+	 DEC_MEMORY_STAT_BY(STAT_NavMeshRender_SpatialIndexMemory, ReportedSpatialIndexBytes);
+	 DEC_MEMORY_STAT_BY(STAT_NavMeshRender_TileCacheMemory, ReportedTileCacheBytes);
+	 DEC_MEMORY_STAT_BY(STAT_NavMeshRender_RasterMemory, ReportedRasterBytes);
+	 ReportedDynamicMeshBytes = dynamicMeshBytes;
+	 ReportedCompactMeshBytes = compactMeshBytes;
+	 ReportedSpatialIndexBytes = spatialIndexBytes;
+	 ReportedTileCacheBytes = tileCacheBytes;
+	 ReportedRasterBytes = rasterBytes;
+	 INC_MEMORY_STAT_BY(STAT_NavMeshRender_DynamicMeshMemory, ReportedDynamicMeshBytes);
+	 INC_MEMORY_STAT_BY(STAT_NavMeshRender_CompactMeshMemory, ReportedCompactMeshBytes);
+	 INC_MEMORY_STAT_BY(STAT_NavMeshRender_SpatialIndexMemory, ReportedSpatialIndexBytes);
+	 INC_MEMORY_STAT_BY(STAT_NavMeshRender_TileCacheMemory, ReportedTileCacheBytes);
+	 INC_MEMORY_STAT_BY(STAT_NavMeshRender_RasterMemory, ReportedRasterBytes);
+ }
+
+ void ANavMeshRenderer::CopyRenderedMesh(FDynamicMesh3& outMesh) const {
+	 NavMeshRender::InitRenderMesh(outMesh);
+	 UE::Geometry::FDynamicMeshEditor meshEditor(&outMesh);
+	 UE::Geometry::FMeshIndexMappings mappings;
+	 for (UDynamicNavMeshRendererComponent* renderComponent : GetRenderComponents()) {
+		 const FDynamicMesh3* componentMesh = renderComponent->GetMesh();
+		 if (componentMesh->TriangleCount() <= 0) {
+			 continue;
+		 }
+		 mappings.Reset();
+		 meshEditor.AppendMesh(componentMesh, mappings);
+	 }
+	 FDynamicMesh3 compactMesh;
+	 for (const TPair<FIntPoint, TObjectPtr<UNavMeshCompactRenderComponent>>& compactChunk : CompactComponents) {
+		 if (!IsValid(compactChunk.Value) || compactChunk.Value->GetNumTriangles() <= 0) {
+			 continue;
+		 }
+		 compactChunk.Value->CopyToMesh(compactMesh);
+		 mappings.Reset();
+		 meshEditor.AppendMesh(&compactMesh, mappings);
+	 }
+ }
+
+ bool ANavMeshRenderer::LaunchAsyncBuild() {
+	 bAsyncBuildPending = false;
+	 TArray<FNavMeshRenderTileSnapshot> tiles;
+	 uint32 settingsHash = 0;
+	 FNavMeshRenderLayout layout;
+	 if (!SnapshotNavMesh(tiles, settingsHash, layout)) {
+		 return false;
+	 }
+	 TArray<FNavMeshRenderAgentBuild> agentBuilds;
+	 SnapshotAgents(layout.Triangulation, agentBuilds);
+	 const uint32 buildSerial = ++LatestBuildSerial;
+	 bAsyncBuildInFlight = true;
+	 TWeakObjectPtr<ANavMeshRenderer> weakThis(this);
+	 // The layout travels with the build and is only committed if the result is applied.
+	 UE::Tasks::Launch(UE_SOURCE_LOCATION, [weakThis, buildSerial, settingsHash, layout = MoveTemp(layout), chunkSizeInTiles = ChunkSizeInTiles, tiles = MoveTemp(tiles), agentBuilds = MoveTemp(agentBuilds)]() mutable {
+		 TSharedRef<TArray<FNavMeshRenderChunk>, ESPMode::ThreadSafe> builtChunks = MakeShared<TArray<FNavMeshRenderChunk>, ESPMode::ThreadSafe>();
+		 NavMeshRender::BuildChunks(layout, tiles, chunkSizeInTiles, *builtChunks);
+		 TSharedRef<TArray<FNavMeshRenderAgentBuild>, ESPMode::ThreadSafe> builtAgents = MakeShared<TArray<FNavMeshRenderAgentBuild>, ESPMode::ThreadSafe>(MoveTemp(agentBuilds));
+		 NavMeshRender::BuildAgentMeshes(layout, *builtAgents);
+		 AsyncTask(ENamedThreads::GameThread, [weakThis, buildSerial, layout = MoveTemp(layout), chunkSizeInTiles, settingsHash, builtChunks, builtAgents]() {
+			 if (ANavMeshRenderer* renderer = weakThis.Get()) {
+				 renderer->FinishAsyncBuild(buildSerial, layout, MoveTemp(*builtChunks), MoveTemp(*builtAgents), chunkSizeInTiles, settingsHash);
+			 }
+		 });
+	 });
+	 return true;
+ }
+
+ void ANavMeshRenderer::FinishAsyncBuild(uint32 buildSerial, const FNavMeshRenderLayout& layout, TArray<FNavMeshRenderChunk>&& builtChunks, TArray<FNavMeshRenderAgentBuild>&& agentBuilds, int chunkSizeInTiles, uint32 settingsHash) {
+	 bAsyncBuildInFlight = false;
+	 // A newer request came in while this was building. Its snapshot replaces this one.
+	 if (bAsyncBuildPending) {
+		 LaunchAsyncBuild();
+		 return;
+	 }
+	 // Superseded by a synchronous update or a clear.
+	 if (buildSerial != LatestBuildSerial) {
+		 return;
+	 }
+	 ApplyBuiltChunks(layout, MoveTemp(builtChunks), MoveTemp(agentBuilds), chunkSizeInTiles, settingsHash);
+ }
+
+ void ANavMeshRenderer::OnNavigationGenerationFinished(ANavigationData* navData) {
+	 if (navData == GetNavMesh()) {
+		 UpdateChangedTiles();
+		 return;
+	 }
+	 for (const TPair<FName, const ARecastNavMesh*>& agentNavMesh : GetAgentNavMeshes()) {
+		 if (agentNavMesh.Value == navData) {
+			 UpdateAgentMeshes();
+			 return;
+		 }
+	 }
+ }
+
+ void ANavMeshRenderer::OnLevelStreamingChanged(ULevel* level, UWorld* world) {
+	 if (world != GetWorld() || bNavStreamingUpdatePending) {
+		 return;
+	 }
+	 // Several levels often stream in the same frame, they are all handled by one update.
+	 bNavStreamingUpdatePending = true;
+	 GetWorldTimerManager().SetTimerForNextTick(this, &ANavMeshRenderer::UpdateStreamedNavTiles);
+ }
+
+ void ANavMeshRenderer::UpdateStreamedNavTiles() {
+	 bNavStreamingUpdatePending = false;
+	 // Cleared renders stay cleared.
+	 if (NumberOfTris < 0 && !IsStreaming()) {
+		 return;
+	 }
+	 // Without per-tile state, e.g. a loaded or compact render, the tiles can't be patched. Rebuilding it off the game thread avoids the hitch.
+	 if (!IsStreaming() && (!IsValid(DynamicNavMeshRender) || !DynamicNavMeshRender->RenderState.IsValid())) {
+		 UpdateMeshAsync();
+		 return;
+	 }
+	 UpdateChangedTiles();
+ }
+
+ void ANavMeshRenderer::UpdateStreaming() {
+	 NAVMESHRENDER_SCOPE_CYCLE_COUNTER(STAT_NavMeshRender_UpdateStreaming);
+	 if (!Streaming.IsValid()) {
+		 return;
+	 }
+	 StreamingTimeSinceUpdate = 0.f;
+	 // Navigation may not be ready yet on the first updates.
+	 if (!Streaming->IsInitialized() && !PrepareStreaming()) {
+		 return;
+	 }
+	 TArray<FVector> viewers;
+	 GetStreamingViewers(viewers);
+	 // Without a viewer, e.g. while a player respawns, the loaded chunks are kept.
+	 if (viewers.IsEmpty()) {
+		 return;
+	 }
+	 TArray<FIntPoint> chunkCoords;
+	 Streaming->GetChunksToUnload(viewers, StreamingRadius + StreamingUnloadMargin, chunkCoords);
+	 for (const FIntPoint& chunkCoord : chunkCoords) {
+		 UnloadStreamingChunk(chunkCoord);
+	 }
+	 if (!chunkCoords.IsEmpty()) {
+		 UpdateRenderStats();
+	 }
+	 const int32 freeBuilds = StreamingMaxBuilds - Streaming->GetNumBuilding();
+	 if (freeBuilds <= 0) {
+		 return;
+	 }
+	 const ARecastNavMesh* navMesh = GetNavMesh();
+	 if (!IsValid(navMesh)) {
+		 return;
+	 }
+	 Streaming->GetChunksToLoad(viewers, StreamingRadius, chunkCoords);
+	 for (int32 i = 0; i < chunkCoords.Num() && i < freeBuilds; i++) {
+		 LaunchStreamingChunkBuild(*navMesh, chunkCoords[i]);
+	 }
+ }
+
+ bool ANavMeshRenderer::IsStreaming() const {
+	 return Streaming.IsValid();
+ }
+
+ bool ANavMeshRenderer::ShouldStream() const {
+	 return bStreamAroundViewers && IsValid(GetWorld()) && GetWorld()->IsGameWorld();
+ }
+
+ void ANavMeshRenderer::RestartStreaming() {
+	 // Supersedes every full update. A fresh streaming state also discards the chunk builds still running.
+	 LatestBuildSerial++;
+	 TimeSlicedBuild.Reset();
+	 Streaming = MakeShared<FNavMeshRenderStreaming>();
+	 UpdateTickEnabled();
+	 UpdateStreaming();
+ }
+
+ bool ANavMeshRenderer::PrepareStreaming() {
+	 FNavMeshRenderLayout layout;
+	 const ARecastNavMesh* navMesh = PrepareBuild(layout);
+	 if (!IsValid(navMesh)) {
+		 return false;
+	 }
+	 // Every chunk is released below and streams in again with this layout.
+	 CommitRenderLayout(layout);
+	 // Whatever was saved or built before is replaced by the chunks around the viewers.
+	 TArray<FIntPoint> chunkCoords;
+	 ChunkComponents.GetKeys(chunkCoords);
+	 for (const FIntPoint& chunkCoord : chunkCoords) {
+		 ReleaseChunkComponent(chunkCoord);
+	 }
+	 DestroyCompactComponents(TSet<FIntPoint>());
+	 FDynamicMesh3 emptyMesh;
+	 NavMeshRender::InitRenderMesh(emptyMesh);
+	 DynamicNavMeshRender->SetMesh(MoveTemp(emptyMesh));
+	 DynamicNavMeshRender->RenderState = MakeShared<FNavMeshRenderMeshState>();
+	 RefreshRenderComponent(DynamicNavMeshRender);
+	 Streaming->RefreshTiles(*navMesh, ChunkSizeInTiles);
+	 BuiltChunkSizeInTiles = Streaming->GetChunkSizeInTiles();
+	 BuiltNavDataHash = 0;
+	 BuiltSettingsHash = 0;
+	 // Queries only cover the loaded chunks, so the index counts as complete as chunks come and go.
+	 SpatialIndex = MakeShared<FNavMeshRenderSpatialIndex>();
+	 SpatialIndex->MarkComplete();
+	 TArray<FNavMeshRenderAgentBuild> agentBuilds;
+	 SnapshotAgents(RenderLayout.Triangulation, agentBuilds);
+	 NavMeshRender::BuildAgentMeshes(RenderLayout, agentBuilds);
+	 ApplyBuiltAgents(MoveTemp(agentBuilds));
+	 RebuildOutline();
+	 // The raster covers the whole nav mesh, not only the streamed chunks.
+	 if (bRasterizeAtlas) {
+		 UpdateRaster();
+	 }
+	 RefreshHighlights();
+	 // Loaded chunks are rebuilt when their tiles regenerate.
+	 if (UNavigationSystemV1* navSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld())) {
+		 navSys->OnNavigationGenerationFinishedDelegate.AddUniqueDynamic(this, &ANavMeshRenderer::OnNavigationGenerationFinished);
+	 }
+	 UpdateRenderStats();
+	 UE_LOG(LogNavigation, Log, TEXT("NavMeshRenderer is streaming chunks within %.0f of the viewers."), StreamingRadius);
+	 return true;
+ }
+
+ void ANavMeshRenderer::RefreshStreamingTiles() {
+	 if (!Streaming->IsInitialized()) {
+		 return;
+	 }
+	 FNavMeshRenderLayout layout;
+	 const ARecastNavMesh* navMesh = PrepareBuild(layout);
+	 if (!IsValid(navMesh)) {
+		 return;
+	 }
+	 // Moved bounds or floors change every UV, so everything streams in again.
+	 if (layout != RenderLayout) {
+		 RestartStreaming();
+		 return;
+	 }
+	 Streaming->RefreshTiles(*navMesh, ChunkSizeInTiles);
+	 for (const TPair<FIntPoint, TObjectPtr<UDynamicNavMeshRendererComponent>>& chunk : ChunkComponents) {
+		 FNavMeshRenderStreamingChunk* streamingChunk = Streaming->FindChunk(chunk.Key);
+		 if (!streamingChunk || streamingChunk->bStale || !IsValid(chunk.Value) || !chunk.Value->RenderState.IsValid()) {
+			 continue;
+		 }
+		 for (int32 tileIndex : streamingChunk->Tiles) {
+			 if (chunk.Value->RenderState->TileSignatures.FindRef(tileIndex) != NavMeshRender::GetTileSignature(*navMesh, tileIndex)) {
+				 streamingChunk->bStale = true;
+				 break;
+			 }
+		 }
+	 }
+	 UpdateStreaming();
+ }
+
+ void ANavMeshRenderer::GetStreamingViewers(TArray<FVector>& outViewers) const {
+	 outViewers.Reset();
+	 for (FConstPlayerControllerIterator it = GetWorld()->GetPlayerControllerIterator(); it; ++it) {
+		 const APlayerController* playerController = it->Get();
+		 if (!IsValid(playerController) || !playerController->IsLocalController()) {
+			 continue;
+		 }
+		 FVector viewLocation;
+		 FRotator viewRotation;
+		 playerController->GetPlayerViewPoint(viewLocation, viewRotation);
+		 outViewers.Add(viewLocation);
+	 }
+ }
+
+ void ANavMeshRenderer::LaunchStreamingChunkBuild(const ARecastNavMesh& navMesh, const FIntPoint& chunkCoord) {
+	 FNavMeshRenderStreamingChunk* chunk = Streaming->FindChunk(chunkCoord);
+	 if (!chunk) {
+		 return;
+	 }
+	 // Only copying the tiles happens here, triangulating and merging them runs on a worker.
+	 TArray<FNavMeshRenderTileSnapshot> tiles;
+	 TSet<NavNodeRef> finishedPolys;
+	 FNavMeshRenderTileSnapshot tile;
+	 for (int32 tileIndex : chunk->Tiles) {
+		 if (NavMeshRender::GatherTile(navMesh, tileIndex, RenderLayout.Triangulation, finishedPolys, tile)) {
+			 tiles.Add(MoveTemp(tile));
+		 }
+	 }
+	 const uint32 buildSerial = ++StreamingBuildSerial;
+	 chunk->BuildSerial = buildSerial;
+	 TWeakObjectPtr<ANavMeshRenderer> weakThis(this);
+	 UE::Tasks::Launch(UE_SOURCE_LOCATION, [weakThis, buildSerial, chunkCoord, layout = RenderLayout, chunkSizeInTiles = Streaming->GetChunkSizeInTiles(), tiles = MoveTemp(tiles)]() {
+		 TSharedRef<TArray<FNavMeshRenderChunk>, ESPMode::ThreadSafe> builtChunks = MakeShared<TArray<FNavMeshRenderChunk>, ESPMode::ThreadSafe>();
+		 NavMeshRender::BuildChunks(layout, tiles, chunkSizeInTiles, *builtChunks);
+		 AsyncTask(ENamedThreads::GameThread, [weakThis, buildSerial, chunkCoord, builtChunks]() {
+			 if (ANavMeshRenderer* renderer = weakThis.Get()) {
+				 renderer->FinishStreamingChunkBuild(buildSerial, chunkCoord, MoveTemp(*builtChunks));
+			 }
+		 });
+	 });
+ }
+
+ void ANavMeshRenderer::FinishStreamingChunkBuild(uint32 buildSerial, const FIntPoint& chunkCoord, TArray<FNavMeshRenderChunk>&& builtChunks) {
+	 FNavMeshRenderStreamingChunk* chunk = Streaming.IsValid() ? Streaming->FindChunk(chunkCoord) : nullptr;
+	 // Unloaded, restarted or cleared while building.
+	 if (!chunk || chunk->BuildSerial != buildSerial) {
+		 return;
+	 }
+	 chunk->BuildSerial = 0;
+	 chunk->bLoaded = true;
+	 chunk->bStale = false;
+	 UpdateOutlineTiles(chunk->Tiles);
+	 if (const TObjectPtr<UDynamicNavMeshRendererComponent>* existing = ChunkComponents.Find(chunkCoord)) {
+		 if (IsValid(*existing) && (*existing)->RenderState.IsValid() && SpatialIndex.IsValid()) {
+			 for (const TPair<int32, uint64>& builtTile : (*existing)->RenderState->TileSignatures) {
+				 SpatialIndex->RemoveTile(builtTile.Key);
+			 }
+		 }
+	 }
+	 // Every tile of the chunk was empty.
+	 if (builtChunks.IsEmpty()) {
+		 ReleaseChunkComponent(chunkCoord);
+		 UpdateRenderStats();
+		 return;
+	 }
+	 FNavMeshRenderChunk& builtChunk = builtChunks[0];
+	 UDynamicNavMeshRendererComponent* chunkComponent = FindOrAddChunkComponent(chunkCoord);
+	 chunkComponent->SetMesh(MoveTemp(builtChunk.Mesh));
+	 chunkComponent->RenderState = builtChunk.State;
+	 RefreshRenderComponent(chunkComponent);
+	 if (SpatialIndex.IsValid()) {
+		 for (FNavMeshRenderTileIndex& tileIndex : builtChunk.TileIndices) {
+			 SpatialIndex->AddTile(MoveTemp(tileIndex));
+		 }
+	 }
+	 INC_DWORD_STAT(STAT_NavMeshRender_ChunksStreamedIn);
+	 UpdateRenderStats();
+ }
+
+ void ANavMeshRenderer::UnloadStreamingChunk(const FIntPoint& chunkCoord) {
+	 Streaming->MarkUnloaded(chunkCoord);
+	 if (const FNavMeshRenderStreamingChunk* chunk = Streaming->FindChunk(chunkCoord)) {
+		 UpdateOutlineTiles(chunk->Tiles);
+	 }
+	 const TObjectPtr<UDynamicNavMeshRendererComponent>* chunkComponent = ChunkComponents.Find(chunkCoord);
+	 if (!chunkComponent) {
+		 return;
+	 }
+	 if (IsValid(*chunkComponent) && (*chunkComponent)->RenderState.IsValid() && SpatialIndex.IsValid()) {
+		 for (const TPair<int32, uint64>& builtTile : (*chunkComponent)->RenderState->TileSignatures) {
+			 SpatialIndex->RemoveTile(builtTile.Key);
+		 }
+	 }
+	 ReleaseChunkComponent(chunkCoord);
+	 INC_DWORD_STAT(STAT_NavMeshRender_ChunksStreamedOut);
+ }
+
+ bool ANavMeshRenderer::UpdateRaster(int32 size) {
+	 const ARecastNavMesh* navMesh = GetNavMesh();
+	 if (!IsValid(navMesh)) {
+		 return false;
+	 }
+	 if (!Raster.IsValid()) {
+		 Raster = MakeShared<FNavMeshRenderRaster>();
+	 }
+	 const int32 rasterSize = FMath::Max(size > 0 ? size : RasterSize, 1);
+	 const bool bCleared = Raster->SetLayout(RenderLayout, FIntPoint(rasterSize, rasterSize));
+	 const int32 changedTiles = Raster->UpdateTiles(*navMesh);
+	 TArray<FIntRect> updatedRects;
+	 Raster->Rasterize(updatedRects);
+	 UploadRaster(updatedRects, bCleared);
+	 UpdateMemoryStats();
+	 if (changedTiles > 0) {
+		 UE_LOG(LogNavigation, Log, TEXT("NavMeshRenderer rasterized %d changed tiles into %d bins."), changedTiles, updatedRects.Num());
+	 }
+	 return true;
+ }
+
+ UTexture2D* ANavMeshRenderer::GetRasterTexture() const {
+	 return RasterTexture;
+ }
+
+ TConstArrayView<FColor> ANavMeshRenderer::GetRasterTexels() const {
+	 return Raster.IsValid() ? TConstArrayView<FColor>(Raster->GetTexels()) : TConstArrayView<FColor>();
+ }
+
+ FIntPoint ANavMeshRenderer::GetRasterSize() const {
+	 return Raster.IsValid() ? Raster->GetSize() : FIntPoint::ZeroValue;
+ }
+
+ void ANavMeshRenderer::UploadRaster(const TArray<FIntRect>& updatedRects, bool bFullUpload) {
+	 if (!bRasterTexture || !FApp::CanEverRender() || !Raster.IsValid() || Raster->IsEmpty()) {
+		 RasterTexture = nullptr;
+		 return;
+	 }
+	 UploadTexels(RasterTexture, Raster->GetTexels(), Raster->GetSize(), updatedRects, bFullUpload);
+ }
+
+ bool ANavMeshRenderer::UploadTexels(TObjectPtr<UTexture2D>& texture, TConstArrayView<FColor> texels, const FIntPoint& size, const TArray<FIntRect>& updatedRects, bool bFullUpload) {
+	 if (!IsValid(texture) || texture->GetSizeX() != size.X || texture->GetSizeY() != size.Y) {
+		 texture = UTexture2D::CreateTransient(size.X, size.Y, PF_B8G8R8A8);
+		 if (!IsValid(texture)) {
+			 return false;
+		 }
+		 // The channels are data, not colors.
+		 texture->SRGB = false;
+		 texture->Filter = TF_Nearest;
+		 texture->AddressX = TA_Clamp;
+		 texture->AddressY = TA_Clamp;
+		 FTexture2DMipMap& mip = texture->GetPlatformData()->Mips[0];
+		 FMemory::Memcpy(mip.BulkData.Lock(LOCK_READ_WRITE), texels.GetData(), texels.Num() * sizeof(FColor));
+		 mip.BulkData.Unlock();
+		 texture->UpdateResource();
+		 return true;
+	 }
+	 TArray<FIntRect> uploadRects;
+	 if (bFullUpload) {
+		 uploadRects.Add(FIntRect(FIntPoint::ZeroValue, size));
+	 }
+	 else {
+		 uploadRects = updatedRects;
+	 }
+	 if (uploadRects.IsEmpty()) {
+		 return false;
+	 }
+	 // The rects are stacked into a staging copy, since the texels may change again before the render thread reads them.
+	 int32 stagingWidth = 0;
+	 int32 stagingHeight = 0;
+	 for (const FIntRect& rect : uploadRects) {
+		 stagingWidth = FMath::Max(stagingWidth, rect.Width());
+		 stagingHeight += rect.Height();
+	 }
+	 FColor* stagingTexels = new FColor[stagingWidth * stagingHeight];
+	 FUpdateTextureRegion2D* regions = new FUpdateTextureRegion2D[uploadRects.Num()];
+	 int32 stagingRow = 0;
+	 for (int32 r = 0; r < uploadRects.Num(); r++) {
+		 const FIntRect& rect = uploadRects[r];
+		 regions[r] = FUpdateTextureRegion2D(rect.Min.X, rect.Min.Y, 0, stagingRow, rect.Width(), rect.Height());
+		 for (int32 y = 0; y < rect.Height(); y++) {
+			 FMemory::Memcpy(&stagingTexels[(stagingRow + y) * stagingWidth], &texels[(rect.Min.Y + y) * size.X + rect.Min.X], rect.Width() * sizeof(FColor));
+		 }
+		 stagingRow += rect.Height();
+	 }
+	 texture->UpdateTextureRegions(0, uploadRects.Num(), regions, stagingWidth * sizeof(FColor), sizeof(FColor), (uint8*)stagingTexels,
+		 [](uint8* srcData, const FUpdateTextureRegion2D* srcRegions) {
+			 delete[] (FColor*)srcData;
+			 delete[] srcRegions;
+		 });
+	 return false;
+ }
+
+ int32 ANavMeshRenderer::SetPolyHighlights(const TArray<int64>& polyRefs, FLinearColor color) {
+	 NAVMESHRENDER_SCOPE_CYCLE_COUNTER(STAT_NavMeshRender_SetPolyHighlights);
+	 if (!bPolyHighlights || bCompactRender) {
+		 return 0;
+	 }
+	 const ARecastNavMesh* navMesh = GetNavMesh();
+	 if (!IsValid(navMesh)) {
+		 return 0;
+	 }
+	 if (!Highlights.IsValid()) {
+		 Highlights = MakeShared<FNavMeshRenderHighlights>();
+		 Highlights->Update(*navMesh, RenderLayout);
+	 }
+	 // Stored as is, the texture isn't sRGB.
+	 const FColor texel = color.QuantizeRound();
+	 int32 retVal = 0;
+	 for (int64 polyRef : polyRefs) {
+		 retVal += Highlights->SetPoly(*navMesh, RenderLayout, (NavNodeRef)polyRef, texel) ? 1 : 0;
+	 }
+	 RequestHighlightUpload();
+	 return retVal;
+ }
+
+ void ANavMeshRenderer::ClearPolyHighlights() {
+	 if (!Highlights.IsValid()) {
+		 return;
+	 }
+	 Highlights->ClearAll();
+	 RequestHighlightUpload();
+ }
+
+ UTexture2D* ANavMeshRenderer::GetHighlightTexture() const {
+	 return HighlightTexture;
+ }
+
+ void ANavMeshRenderer::RefreshHighlights() {
+	 const ARecastNavMesh* navMesh = bPolyHighlights && !bCompactRender ? GetNavMesh() : nullptr;
+	 if (!IsValid(navMesh)) {
+		 if (Highlights.IsValid() || IsValid(HighlightTexture)) {
+			 Highlights.Reset();
+			 HighlightTexture = nullptr;
+			 ApplyMaterialParameters();
+		 }
+		 return;
+	 }
+	 if (!Highlights.IsValid()) {
+		 Highlights = MakeShared<FNavMeshRenderHighlights>();
+	 }
+	 Highlights->Update(*navMesh, RenderLayout);
+	 UploadHighlights();
+ }
+
+ void ANavMeshRenderer::RequestHighlightUpload() {
+	 if (bHighlightUploadPending || !IsValid(GetWorld())) {
+		 return;
+	 }
+	 // However many highlights change in a frame, they are uploaded together.
+	 bHighlightUploadPending = true;
+	 GetWorldTimerManager().SetTimerForNextTick(this, &ANavMeshRenderer::UploadHighlights);
+ }
+
+ void ANavMeshRenderer::UploadHighlights() {
+	 bHighlightUploadPending = false;
+	 if (!Highlights.IsValid() || Highlights->IsEmpty() || !FApp::CanEverRender()) {
+		 return;
+	 }
+	 TArray<FIntRect> dirtyRects;
+	 Highlights->TakeDirtyRects(dirtyRects);
+	 if (UploadTexels(HighlightTexture, Highlights->GetTexels(), Highlights->GetSize(), dirtyRects, false)) {
+		 // A new texture has to be handed to the material again.
+		 ApplyMaterialParameters();
+	 }
+ }
+
+ void ANavMeshRenderer::RefreshOutline() {
+	 if (!bRenderOutline) {
+		 DestroyOutline();
+		 return;
+	 }
+	 if (!Outline.IsValid() || Outline->IsEmpty() || !Outline->Matches(bOutlineTileEdges, bOutlineOffMeshLinks)) {
+		 RebuildOutline();
+		 return;
+	 }
+	 DrawOutline();
+ }
+
+ void ANavMeshRenderer::RebuildOutline() {
+	 if (!bRenderOutline) {
+		 DestroyOutline();
+		 return;
+	 }
+	 const ARecastNavMesh* navMesh = GetNavMesh();
+	 if (!IsValid(navMesh)) {
+		 return;
+	 }
+	 if (!Outline.IsValid()) {
+		 Outline = MakeShared<FNavMeshRenderOutline>();
+	 }
+	 Outline->Reset(bOutlineTileEdges, bOutlineOffMeshLinks);
+	 // An empty or cleared render gets no outline either.
+	 if (NumberOfTris > 0 || IsStreaming()) {
+		 auto isTileDrawn = [this, navMesh](int32 tileIndex) {
+			 return IsTileRendered(*navMesh, tileIndex);
+		 };
+		 const int tileCount = navMesh->GetNavMeshTilesCount();
+		 for (int32 v = 0; v < tileCount; v++) {
+			 if (isTileDrawn(v)) {
+				 Outline->GatherTile(*navMesh, v, isTileDrawn);
+			 }
+		 }
+	 }
+	 DrawOutline();
+ }
+
+ void ANavMeshRenderer::UpdateOutlineTiles(const TArray<int32>& tileIndices) {
+	 if (!bRenderOutline || !Outline.IsValid()) {
+		 return;
+	 }
+	 const ARecastNavMesh* navMesh = GetNavMesh();
+	 if (!IsValid(navMesh)) {
+		 return;
+	 }
+	 // Which tile draws a shared edge depends on its neighbors, so they are gathered again as well.
+	 TSet<int32> outlineTiles;
+	 Outline->GetTilesWithNeighbors(*navMesh, tileIndices, outlineTiles);
+	 auto isTileDrawn = [this, navMesh](int32 tileIndex) {
+		 return IsTileRendered(*navMesh, tileIndex);
+	 };
+	 for (int32 tileIndex : outlineTiles) {
+		 if (isTileDrawn(tileIndex)) {
+			 Outline->GatherTile(*navMesh, tileIndex, isTileDrawn);
+		 }
+		 else {
+			 Outline->RemoveTile(tileIndex);
+		 }
+	 }
+	 DrawOutline();
+ }
+
+ void ANavMeshRenderer::DrawOutline() {
+	 if (!Outline.IsValid()) {
+		 return;
+	 }
+	 if (!IsValid(OutlineComponent)) {
+		 const FName outlineName = MakeUniqueObjectName(this, ULineBatchComponent::StaticClass(), TEXT("NavMeshRenderOutline"));
+		 OutlineComponent = NewObject<ULineBatchComponent>(this, outlineName, RF_Transient);
+		 // The default bounds are infinite, which would defeat culling.
+		 OutlineComponent->bCalculateAccurateBounds = true;
+		 OutlineComponent->SetupAttachment(GetRootComponent());
+		 OutlineComponent->RegisterComponent();
+	 }
+	 TArray<FBatchedLine> lines;
+	 Outline->GetLines(ZOffset, OutlineThickness, OutlineColor, OutlineTileEdgeColor, OutlineOffMeshLinkColor, lines);
+	 // All lines go out in one batch, so the whole outline is a single draw.
+	 OutlineComponent->Flush();
+	 OutlineComponent->DrawLines(lines);
+	 OutlineComponent->SetCullDistance(OutlineCullDistance);
+	 OutlineComponent->UpdateBounds();
+	 OutlineComponent->MarkRenderStateDirty();
+	 INC_DWORD_STAT(STAT_NavMeshRender_RenderStatesDirtied);
+ }
+
+ void ANavMeshRenderer::DestroyOutline() {
+	 Outline.Reset();
+	 if (IsValid(OutlineComponent)) {
+		 OutlineComponent->DestroyComponent();
+	 }
+	 OutlineComponent = nullptr;
+ }
+
+ bool ANavMeshRenderer::IsTileRendered(const ARecastNavMesh& navMesh, int32 tileIndex) const {
+	 if (!IsStreaming()) {
+		 return true;
+	 }
+	 int32 tileX = 0;
+	 int32 tileY = 0;
+	 int32 tileLayer = 0;
+	 if (!navMesh.GetNavMeshTileXY(tileIndex, tileX, tileY, tileLayer)) {
+		 return false;
+	 }
+	 const FNavMeshRenderStreamingChunk* chunk = Streaming->FindChunk(NavMeshRender::GetChunkCoord(tileX, tileY, Streaming->GetChunkSizeInTiles()));
+	 return chunk && chunk->bLoaded;
+ }
+
+ void ANavMeshRenderer::UpdateTickEnabled() {
+	 SetActorTickEnabled(TimeSlicedBuild.IsValid() || Streaming.IsValid());
+ }
+
+ FVector2f ANavMeshRenderer::UVCoord(const FVector& location, float centralHeight) const {
+	 return RenderLayout.UVCoord(location, centralHeight);
+ }
+
+ const ARecastNavMesh* ANavMeshRenderer::GetNavMesh() const {
+	 if (!IsValid(GetWorld())) {
+		 UE_LOG(LogNavigation, Warning, TEXT("NavMeshRenderer found no World"));
+		 return nullptr;
+	 }
+	 if (IsValid(GetWorld()->GetNavigationSystem())) {
+		 if (const ARecastNavMesh* mainNavMesh = Cast<ARecastNavMesh>(GetWorld()->GetNavigationSystem()->GetMainNavData())) {
+			 return mainNavMesh;
+		 }
+	 }
+	 // Commandlets and other tools may initialize a world without navigation registering its data.
+	 // Agents are matched by name like GetAgentNavMeshes does, so another agent's nav mesh is only used when none is the default agent's.
+	 if (GetWorld()->bIsWorldInitialized) {
+		 const UNavigationSystemV1* navSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+		 const FName defaultAgentName = (IsValid(navSys) ? navSys : GetDefault<UNavigationSystemV1>())->GetDefaultSupportedAgentConfig().Name;
+		 const ARecastNavMesh* anyNavMesh = nullptr;
+		 for (TActorIterator<ARecastNavMesh> it(GetWorld()); it; ++it) {
+			 if (it->GetConfig().Name == defaultAgentName) {
+				 return *it;
+			 }
+			 if (!anyNavMesh) {
+				 anyNavMesh = *it;
+			 }
+		 }
+		 if (anyNavMesh) {
+			 return anyNavMesh;
+		 }
+	 }
+	 if (!IsValid(GetWorld()->GetNavigationSystem())) {
+		 UE_LOG(LogNavigation, Warning, TEXT("NavMeshRenderer found no Navigation System"));
+	 }
+	 return nullptr;
+ }
+
+ void ANavMeshRenderer::PackFloorUVs(const ARecastNavMesh& navMesh, FNavMeshRenderLayout& layout) const {
+	 TArray<FBox2D> floorBounds;
+	 floorBounds.Init(FBox2D(ForceInit), layout.AdditionalFloorHeights.Num() + 1);
+	 const int tileCount = navMesh.GetNavMeshTilesCount();
+	 for (int32 v = 0; v < tileCount; v++) {
+		 const FBox tileBounds = navMesh.GetNavMeshTileBounds(v);
+		 if (!tileBounds.IsValid) {
+			 continue;
+		 }
+		 // Polys pick their floor by a height within their tile's, so the tile covers them on every floor its heights reach.
+		 const FBox2D relativeBounds(FVector2D(tileBounds.Min - layout.NavMeshCorner), FVector2D(tileBounds.Max - layout.NavMeshCorner));
+		 const int maxFloor = FMath::Min(layout.GetFloor(tileBounds.Max.Z), floorBounds.Num() - 1);
+		 for (int floor = layout.GetFloor(tileBounds.Min.Z); floor <= maxFloor; floor++) {
+			 floorBounds[floor] += relativeBounds;
+		 }
+	 }
+	 FNavMeshRenderLayout::PackFloors(floorBounds, layout.UV_IslandMargins, layout.FloorUVTransforms);
+ }
+
+ void ANavMeshRenderer::RefreshRenderLayout() {
+	 RenderLayout.NavMeshCorner = NavMeshCorner;
+	 RenderLayout.NavMeshSize = NavMeshSize;
+	 RenderLayout.AdditionalFloorHeights = AdditionalFloorHeights;
+	 // GetFloor binary searches the heights.
+	 RenderLayout.AdditionalFloorHeights.Sort();
+	 RenderLayout.UV_IslandMargins = UV_IslandMargins;
+	 RenderLayout.ZOffset = ZOffset;
+	 RenderLayout.NumberOfFloors = FMath::Max(NumberOfFloors, 1);
+	 RenderLayout.FloorRowSize = FMath::Max(FloorRowSize, 1);
+	 RenderLayout.FloorUVTransforms = FloorUVTransforms;
+	 RenderLayout.Triangulation = Triangulation;
+	 RenderLayout.bPolyHighlights = bPolyHighlights && !bCompactRender;
+	 RenderLayout.HighlightTileStride = RenderLayout.bPolyHighlights ? HighlightTileStride : 0;
+ }
+
+ UMaterialInterface* ANavMeshRenderer::GetRenderMaterial() const {
+	 return IsValid(ParameterMaterial) ? ParameterMaterial.Get() : NavMeshMaterial.Get();
+ }
+
+ void ANavMeshRenderer::ApplyMaterialParameters() {
+	 // The plain material is used until a mask is set, floors are packed or polys can be highlighted.
+	 if ((AreaMask != -1 || !FloorUVTransforms.IsEmpty() || IsValid(HighlightTexture)) && IsValid(NavMeshMaterial) && (!IsValid(ParameterMaterial) || ParameterMaterial->Parent != NavMeshMaterial)) {
+		 ParameterMaterial = UMaterialInstanceDynamic::Create(NavMeshMaterial, this);
+		 ParameterMaterial->SetFlags(RF_Transient);
+	 }
+	 if (IsValid(ParameterMaterial)) {
+		 // 16 bits per parameter, so each one is exact as a float.
+		 for (int32 i = 0; i < 4; i++) {
+			 ParameterMaterial->SetScalarParameterValue(*FString::Printf(TEXT("AreaMask%d"), i), (float)((AreaMask >> (i * 16)) & 0xFFFF));
+		 }
+		 for (int32 floor = 0; floor <= RenderLayout.AdditionalFloorHeights.Num(); floor++) {
+			 FVector2D scale;
+			 FVector2D offset;
+			 GetFloorUVTransform(floor, scale, offset);
+			 ParameterMaterial->SetVectorParameterValue(*FString::Printf(TEXT("FloorUVTransform%d"), floor), FLinearColor(scale.X, scale.Y, offset.X, offset.Y));
+		 }
+		 if (IsValid(HighlightTexture)) {
+			 ParameterMaterial->SetTextureParameterValue(TEXT("HighlightTexture"), HighlightTexture);
+			 ParameterMaterial->SetVectorParameterValue(TEXT("HighlightTextureSize"), FLinearColor((float)HighlightTexture->GetSizeX(), (float)HighlightTexture->GetSizeY(), 0.f, 0.f));
+		 }
+	 }
+	 // Only materials are swapped, the meshes are left alone.
+	 UMaterialInterface* material = GetRenderMaterial();
+	 if (IsValid(material)) {
+		 for (UDynamicNavMeshRendererComponent* renderComponent : GetRenderComponents()) {
+			 if (renderComponent->GetMaterial(0) != material) {
+				 renderComponent->SetMaterial(0, material);
+			 }
+		 }
+		 for (const TPair<FIntPoint, TObjectPtr<UNavMeshCompactRenderComponent>>& compactChunk : CompactComponents) {
+			 if (IsValid(compactChunk.Value) && compactChunk.Value->GetMaterial(0) != material) {
+				 compactChunk.Value->SetMaterial(0, material);
+			 }
+		 }
+	 }
+	 RefreshAgentComponents();
+ }
+
+ void ANavMeshRenderer::FinishedProcessing() {
+	 UE_LOG(LogNavigation, Warning, TEXT("NavMeshRenderer Finished processing mesh."));
 	 OnMeshUpdate.Broadcast();
  }
 
  void ANavMeshRenderer::DrawFloors() {
+	 NAVMESHRENDER_SCOPE_CYCLE_COUNTER(STAT_NavMeshRender_DrawFloors);
 	 if (NavMeshSize.Z < 1) {
 		 return;
 	 }
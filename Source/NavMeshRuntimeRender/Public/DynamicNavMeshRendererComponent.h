@@ -6,6 +6,8 @@
 #include "Components/DynamicMeshComponent.h"
 #include "DynamicNavMeshRendererComponent.generated.h"
 
+struct FNavMeshRenderMeshState;
+
 /**
  * This class was just created to guarantee that proper bounds were set.
  */
@@ -18,4 +20,12 @@ public:
 	virtual uint64 GetHiddenEditorViews() const override;
 	UPROPERTY()
 	FVector BoundsExtents;
+	/*
+	* When false the bounds fit the mesh itself, so render chunks can be culled individually.
+	*/UPROPERTY()
+	bool bUseNavMeshBounds = true;
+	/*
+	* Per-tile bookkeeping of the mesh. Null when the mesh was not built this session.
+	*/
+	TSharedPtr<FNavMeshRenderMeshState> RenderState;
 };
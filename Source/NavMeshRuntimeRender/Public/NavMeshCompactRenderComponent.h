@@ -0,0 +1,83 @@
+// Cutter H // 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/MeshComponent.h"
+#include "NavMeshCompactRenderComponent.generated.h"
+
+namespace UE::Geometry { class FDynamicMesh3; }
+
+/**
+ * Lightweight render of a flat nav mesh chunk.
+ * Keeps only quantized positions, quantized UVs and 16-bit indices when the chunk is small enough. Normals are always up and there are no vertex colors.
+ * The quantization only saves CPU memory. The proxy uploads the same vertex streams a static mesh does, except colors.
+ * Positions are quantized on a grid shared by every chunk of the render, so chunk borders stay closed.
+ * Unlike UDynamicNavMeshRendererComponent the mesh can't be edited once set.
+ */
+UCLASS(NotBlueprintable, NotBlueprintType)
+class NAVMESHRUNTIMERENDER_API UNavMeshCompactRenderComponent : public UMeshComponent
+{
+	GENERATED_BODY()
+public:
+	UNavMeshCompactRenderComponent();
+	/*
+	* Quantizes the mesh into this component on 65535 steps across quantizeGrid, see FNavMeshRenderLayout::GetQuantizeGrid.
+	* Vertices that aren't used by a triangle are dropped. UVs are read from the primary UV overlay.
+	*/
+	void SetMesh(const UE::Geometry::FDynamicMesh3& mesh, const FBox& quantizeGrid);
+	/*
+	* Rebuilds a dynamic mesh from the stored data, e.g. for saving.
+	*/
+	void CopyToMesh(UE::Geometry::FDynamicMesh3& outMesh) const;
+	void ClearMesh();
+
+	int32 GetNumVertices() const {
+		return Positions.Num() / 3;
+	}
+	int32 GetNumTriangles() const;
+	/*
+	* Bytes held by the stored mesh data. Render resources are not counted.
+	*/
+	SIZE_T GetDataSize() const;
+	FVector3f GetVertexPosition(int32 vertexIndex) const;
+	FVector2f GetVertexUV(int32 vertexIndex) const;
+	uint32 GetIndex(int32 index) const {
+		return Indices16.Num() > 0 ? (uint32)Indices16[index] : Indices32[index];
+	}
+	int32 GetNumIndices() const {
+		return Indices16.Num() > 0 ? Indices16.Num() : Indices32.Num();
+	}
+	const FBox& GetQuantizeGrid() const {
+		return QuantizeGrid.IsValid ? QuantizeGrid : LocalBounds;
+	}
+
+	virtual FPrimitiveSceneProxy* CreateSceneProxy() override;
+	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+	virtual int32 GetNumMaterials() const override;
+
+private:
+	/*
+	* Positions are stored as steps of (QuantizeGrid size / 65535) from QuantizeGrid.Min.
+	* Renders saved before the grid was shared leave it invalid and were quantized across LocalBounds.
+	*/UPROPERTY()
+	FBox QuantizeGrid = FBox(ForceInit);
+	/*
+	* Bounds of the quantized vertices.
+	*/UPROPERTY()
+	FBox LocalBounds = FBox(ForceInit);
+	/*
+	* Quantized XYZ of each vertex.
+	*/UPROPERTY()
+	TArray<uint16> Positions;
+	/*
+	* Quantized UV of each vertex, 0 to 65535 for 0 to 1.
+	*/UPROPERTY()
+	TArray<uint16> UVs;
+	/*
+	* Only one of these is filled, depending on whether the vertices fit in 16 bits.
+	*/UPROPERTY()
+	TArray<uint16> Indices16;
+	UPROPERTY()
+	TArray<uint32> Indices32;
+};
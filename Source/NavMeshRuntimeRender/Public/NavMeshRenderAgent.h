@@ -0,0 +1,29 @@
+// Cutter H // 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NavMeshRenderAgent.generated.h"
+
+class UMaterialInterface;
+
+/*
+ * An additional agent whose nav mesh is rendered alongside the main one.
+ */
+USTRUCT(BlueprintType)
+struct NAVMESHRUNTIMERENDER_API FNavMeshRenderAgent
+{
+	GENERATED_BODY()
+	/*
+	* Name of the agent in the Navigation System's Supported Agents.
+	*/UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NavMesh Render")
+	FName AgentName;
+	/*
+	* Material for this agent. Falls back to the renderer's material when empty.
+	*/UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NavMesh Render", meta = (DisplayThumbnail = "false"))
+	TObjectPtr<UMaterialInterface> Material;
+	/*
+	* Hides the agent's render without rebuilding it.
+	*/UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NavMesh Render")
+	bool bVisible = true;
+};
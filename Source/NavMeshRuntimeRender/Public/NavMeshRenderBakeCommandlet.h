@@ -0,0 +1,74 @@
+// Cutter H // 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "NavMeshRenderBakeCommandlet.generated.h"
+
+class ANavMeshRenderer;
+
+/**
+ * Bakes the nav mesh render of every given map into a Static Mesh Asset without opening the editor.
+ * Maps whose nav tile data and render settings hash the same as their last bake are skipped.
+ *
+ * UnrealEditor-Cmd.exe <Project>.uproject -run=NavMeshRenderBake -Maps=/Game/Maps/A+/Game/Maps/B
+ *	-Maps=			Long package names of the maps, separated by +.
+ *	-MapDir=		Bakes every map under this content path instead, e.g. /Game/Maps.
+ *	-SaveLocation=	Folder under /Game/ to save into. Defaults to the map renderer's Save Location.
+ *	-HashDir=		Where the last baked hashes are kept. Defaults to Saved/NavMeshRenderBake.
+ *	-Force			Bakes every map even if its hash is unchanged.
+ *	-RasterSize=	Also rasterizes the floor atlas on the CPU at this many texels square and writes it as <Map>_NavMeshRaster.png.
+ *					<Map> is the map's full package path with / replaced by _, e.g. Game_Maps_A, which also names the saved asset.
+ *	-RasterDir=		Where the rasters are written. Defaults to Saved/NavMeshRenderBake.
+ *	-Processes=		Splits the maps across this many child processes. Ignored when -ShardCount is given.
+ *	-ShardIndex= -ShardCount=	Only bakes every ShardCount-th map starting at ShardIndex.
+ */
+UCLASS()
+class NAVMESHRUNTIMERENDER_API UNavMeshRenderBakeCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+public:
+	UNavMeshRenderBakeCommandlet();
+	virtual int32 Main(const FString& params) override;
+
+private:
+	enum class EBakeResult : uint8
+	{
+		Baked,
+		Skipped,
+		Failed
+	};
+
+	/*
+	* Loads, bakes and unloads a single map.
+	*/
+	EBakeResult BakeMap(const FString& mapPackageName);
+	/*
+	* Relaunches this commandlet once per shard and waits for all of them. Returns the number of processes that failed.
+	*/
+	int32 RunChildProcesses(const FString& params, int32 processCount) const;
+	/*
+	* Returns the renderer placed in the world, or spawns a transient one.
+	*/
+	ANavMeshRenderer* FindOrSpawnRenderer(UWorld* world) const;
+	/*
+	* The map's full package path flattened into a single name, so maps of the same name in different folders don't share outputs.
+	*/
+	FString GetFlatMapName(const FString& mapPackageName) const;
+	FString GetHashFilePath(const FString& mapPackageName) const;
+	bool ReadBakedHash(const FString& mapPackageName, uint32& outHash) const;
+	void WriteBakedHash(const FString& mapPackageName, uint32 hash) const;
+	void GatherMaps(const FString& mapDir, TArray<FString>& outMaps) const;
+	FString GetRasterFilePath(const FString& mapPackageName) const;
+	/*
+	* Rasterizes the renderer's floor atlas and writes it as a PNG.
+	*/
+	bool WriteRaster(ANavMeshRenderer& renderer, const FString& mapPackageName) const;
+
+	FString SaveLocationOverride;
+	FString HashDir;
+	FString RasterDir;
+	int32 RasterSize = 0;
+	bool bForce = false;
+};
@@ -0,0 +1,31 @@
+// Cutter H // 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "NavMeshRenderBenchmarkCommandlet.generated.h"
+
+/**
+ * Times the render build on synthetic nav meshes and writes the results as JSON. Runs headless, e.g. with -nullrhi.
+ * The synthetic tiles are built into a Detour nav mesh in a world of its own, so every phase of UpdateMesh is timed:
+ * gathering the polys, triangulating, copying attributes, the spatial index and creating the registered components' render state.
+ * Under -nullrhi the render state is created without GPU resources.
+ *
+ * UnrealEditor-Cmd.exe <Project>.uproject -run=NavMeshRenderBenchmark -Tiles=8 -PolysPerTile=64 -Floors=2 -nullrhi
+ *	-Tiles=			Tiles along each side of every floor.
+ *	-PolysPerTile=	Polys in each tile, rounded up to a square grid.
+ *	-Floors=		Stacked copies of the nav mesh, each on its own UV floor.
+ *	-Triangulation=	CenterFan, ConvexFan or DetailMesh.
+ *	-Iterations=	Times every phase is run. Min, mean and max are reported.
+ *	-UVQueries=		Locations used to time UVCoord.
+ *	-Output=		JSON file to write. Defaults to Saved/NavMeshRenderBenchmark/<date>.json.
+ */
+UCLASS()
+class NAVMESHRUNTIMERENDER_API UNavMeshRenderBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+public:
+	UNavMeshRenderBenchmarkCommandlet();
+	virtual int32 Main(const FString& params) override;
+};
@@ -0,0 +1,46 @@
+// Cutter H // 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NavMeshRenderHit.generated.h"
+
+/*
+ * Where a location lands on the rendered nav mesh.
+ */
+USTRUCT(BlueprintType)
+struct NAVMESHRUNTIMERENDER_API FNavMeshRenderHit
+{
+	GENERATED_BODY()
+	/*
+	* False when no rendered triangle was under the location.
+	*/UPROPERTY(BlueprintReadOnly, Category = "NavMesh Render")
+	bool bHit = false;
+	/*
+	* The nav poly the triangle was made from.
+	*/UPROPERTY(BlueprintReadOnly, Category = "NavMesh Render")
+	int64 PolyRef = 0;
+	/*
+	* The nav tile the triangle belongs to.
+	*/UPROPERTY(BlueprintReadOnly, Category = "NavMesh Render")
+	int32 TileIndex = INDEX_NONE;
+	/*
+	* The triangle's index among the triangles built for its tile, in build order. This is not a triangle ID of the render's mesh,
+	* which differs per chunk, changes when tiles are patched and doesn't exist for compact renders.
+	*/UPROPERTY(BlueprintReadOnly, Category = "NavMesh Render")
+	int32 TileTriangleIndex = INDEX_NONE;
+	/*
+	* Weights of the triangle's three corners at the hit.
+	*/UPROPERTY(BlueprintReadOnly, Category = "NavMesh Render")
+	FVector Barycentric = FVector::ZeroVector;
+	/*
+	* The hit on the triangle, without the render's ZOffset.
+	*/UPROPERTY(BlueprintReadOnly, Category = "NavMesh Render")
+	FVector Location = FVector::ZeroVector;
+	/*
+	* The UV of the render at the hit.
+	*/UPROPERTY(BlueprintReadOnly, Category = "NavMesh Render")
+	FVector2D UV = FVector2D::ZeroVector;
+	UPROPERTY(BlueprintReadOnly, Category = "NavMesh Render")
+	int32 Floor = 0;
+};
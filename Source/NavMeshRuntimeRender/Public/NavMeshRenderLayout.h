@@ -0,0 +1,114 @@
+// Cutter H // 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NavMeshRenderLayout.generated.h"
+
+/*
+ * How each nav poly is split into rendered triangles.
+ */
+UENUM(BlueprintType)
+enum class ENavMeshRenderTriangulation : uint8
+{
+	/*
+	* A fan around the poly center. N triangles and one extra vertex per poly.
+	*/
+	CenterFan,
+	/*
+	* A fan from the first vertex. Nav polys are convex, so N-2 triangles cover the same area without the center vertex.
+	*/
+	ConvexFan,
+	/*
+	* The triangles of Recast's detail mesh, which follow the ground height more closely than the polys do.
+	*/
+	DetailMesh
+};
+
+/*
+ * Snapshot of the renderer settings that decide where a vertex ends up and which UV it receives.
+ * This holds no engine objects, so it can be copied to and used from worker threads.
+ */
+struct NAVMESHRUNTIMERENDER_API FNavMeshRenderLayout
+{
+	/*
+	* The negative corner of the nav mesh.
+	*/
+	FVector NavMeshCorner = FVector::ZeroVector;
+	/*
+	* The overall size of the nav mesh.
+	*/
+	FVector NavMeshSize = FVector::OneVector;
+	/*
+	* Floor heights relative to NavMeshCorner. Expected to be sorted.
+	*/
+	TArray<float> AdditionalFloorHeights;
+	/*
+	* Space between the floors on UVs.
+	*/
+	float UV_IslandMargins = 0.f;
+	/*
+	* Raises/Lowers the rendered vertices.
+	*/
+	float ZOffset = 0.f;
+	int NumberOfFloors = 1;
+	int FloorRowSize = 1;
+	/*
+	* Transform of each floor packed by PackFloors, relative to NavMeshCorner: UV = XY * (X, Y) + (Z, W).
+	* Empty gives every floor a full square of the FloorRowSize x FloorRowSize grid instead.
+	*/
+	TArray<FVector4> FloorUVTransforms;
+	ENavMeshRenderTriangulation Triangulation = ENavMeshRenderTriangulation::CenterFan;
+	/*
+	* Gives every vertex a second UV holding the texel of its poly's highlight, see GetHighlightTexel.
+	*/
+	bool bPolyHighlights = false;
+	/*
+	* Highlight texels set aside for each tile slot: the most polys any tile has, rounded up to a power of two. 0 without highlights.
+	* A tile that outgrows it changes the layout, so every UV1 moves and the whole render is rebuilt.
+	*/
+	int32 HighlightTileStride = 0;
+	/*
+	* Width of the highlight texture. Tile slots follow each other in texel order and wrap onto the next row, so the texture stays within
+	* the platform's size limits however many tiles the nav mesh has.
+	*/
+	static constexpr int32 HighlightTextureWidth = 1024;
+
+	/*
+	* Returns the floor index that the given height falls into.
+	*/
+	int GetFloor(float centralHeight) const;
+	/*
+	* Calculates a UV coordinate for the given location.
+	*/
+	FVector2f UVCoord(const FVector& location, float centralHeight) const;
+	/*
+	* Calculates the UV coordinates of many locations at once. outUVs must be as long as locations.
+	* centralHeights must either match locations or be empty, in which case each location's Z is used.
+	* Only reads the layout, so it can be called from any thread on a copy of the layout.
+	*/
+	void UVCoords(TConstArrayView<FVector> locations, TConstArrayView<float> centralHeights, TArrayView<FVector2f> outUVs) const;
+	/*
+	* The floor's UVs as a transform of XY relative to NavMeshCorner: UV = XY * (X, Y) + (Z, W). Matches UVCoord in either layout.
+	*/
+	FVector4 GetFloorUVTransform(int floor) const;
+	/*
+	* The box every rendered vertex falls in: the nav mesh bounds, raised or lowered by ZOffset with a little slack for detail heights.
+	* Compact renders quantize against it, so a vertex shared by two chunks lands on the same grid point in both.
+	*/
+	FBox GetQuantizeGrid() const;
+	/*
+	* Texel of a poly's highlight: texel number tileIndex * HighlightTileStride + polyIndex, wrapped at HighlightTextureWidth.
+	*/
+	FIntPoint GetHighlightTexel(int32 tileIndex, int32 polyIndex) const;
+	/*
+	* Packs floors of the given XY bounds, relative to NavMeshCorner, into the 0 to 1 UV square with margin between them.
+	* Every floor gets the same scale, the largest at which shelf packing still fits them all. Floors with invalid bounds get a zero transform.
+	*/
+	static void PackFloors(TConstArrayView<FBox2D> floorBounds, float margin, TArray<FVector4>& outTransforms);
+
+	bool operator==(const FNavMeshRenderLayout& other) const;
+	bool operator!=(const FNavMeshRenderLayout& other) const {
+		return !(*this == other);
+	}
+};
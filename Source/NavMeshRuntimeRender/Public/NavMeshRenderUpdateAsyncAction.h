@@ -0,0 +1,39 @@
+// Cutter H // 2024
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintAsyncActionBase.h"
+#include "NavMeshRenderer.h"
+#include "NavMeshRenderUpdateAsyncAction.generated.h"
+
+/*
+ * Latent Blueprint node that updates a NavMeshRenderer off the game thread.
+ */
+UCLASS()
+class NAVMESHRUNTIMERENDER_API UNavMeshRenderUpdateAsyncAction : public UBlueprintAsyncActionBase
+{
+	GENERATED_BODY()
+public:
+	/*
+	* Called once the updated mesh has been applied.
+	*/UPROPERTY(BlueprintAssignable)
+	FOnNavMeshRenderGenericSignature Completed;
+	/*
+	* Called if the update could not be started.
+	*/UPROPERTY(BlueprintAssignable)
+	FOnNavMeshRenderGenericSignature Failed;
+	/*
+	* Updates the render to fit the world's NavMesh without blocking the game thread.
+	*/UFUNCTION(BlueprintCallable, Category = "NavMesh Render", meta = (BlueprintInternalUseOnly = "true", DisplayName = "Update Mesh Async"))
+	static UNavMeshRenderUpdateAsyncAction* UpdateNavMeshRenderAsync(ANavMeshRenderer* renderer);
+	virtual void Activate() override;
+
+private:
+	/*
+	* Bound to the renderer's OnMeshUpdate.
+	*/UFUNCTION()
+	void HandleMeshUpdate();
+	UPROPERTY()
+	TObjectPtr<ANavMeshRenderer> Renderer;
+};
@@ -4,12 +4,34 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "NavMeshRenderLayout.h"
+#include "NavMeshRenderHit.h"
+#include "NavMeshRenderAgent.h"
 #include "NavMeshRenderer.generated.h"
 
 class UDynamicNavMeshRendererComponent;
+class UNavMeshCompactRenderComponent;
 class UCustomMeshComponent;
+struct FNavMeshRenderTileSnapshot;
+struct FNavMeshRenderChunk;
+struct FNavMeshRenderAgentBuild;
+class FNavMeshRenderTimeSlicedBuild;
+class FNavMeshRenderSpatialIndex;
+class FNavMeshRenderStreaming;
+class FNavMeshRenderTileCache;
+class FNavMeshRenderOutline;
+class FNavMeshRenderRaster;
+class FNavMeshRenderHighlights;
+class ULineBatchComponent;
+class ULevel;
+class ANavigationData;
+class UStaticMesh;
+class UMaterialInstanceDynamic;
+class UTexture2D;
+namespace UE::Geometry { class FDynamicMesh3; }
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnNavMeshRenderGenericSignature);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnNavMeshRenderProgressSignature, float, progress);
 
 /*
  * Actor that provides a visual representation of the world's navigation mesh during runtime. Most features are present in the Editor.
@@ -24,25 +46,89 @@ public:
 	* Called after updating the mesh.
 	*/UPROPERTY(BlueprintAssignable)
 	FOnNavMeshRenderGenericSignature OnMeshUpdate;
+	/*
+	* Called after every slice of a time sliced update with its progress from 0 to 1.
+	*/UPROPERTY(BlueprintAssignable)
+	FOnNavMeshRenderProgressSignature OnMeshBuildProgress;
 	ANavMeshRenderer();
 	virtual void PostLoadSubobjects(FObjectInstancingGraph* OuterInstanceGraph) override;
 	virtual void OnConstruction(const FTransform& transform) override;
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type endPlayReason) override;
+	virtual void BeginDestroy() override;
+	virtual void Tick(float deltaSeconds) override;
+	virtual bool ShouldTickIfViewportsOnly() const override;
 
 	/*
 	* Returns the rendered component.
 	*/UFUNCTION(BlueprintCallable, Category = "NavMesh Render")
 	const UDynamicMeshComponent* GetNavMeshRender() const;
 	/*
+	* Returns the rendered chunk components. Empty unless ChunkSizeInTiles is set.
+	*/UFUNCTION(BlueprintCallable, Category = "NavMesh Render")
+	TArray<UDynamicMeshComponent*> GetNavMeshRenderChunks() const;
+	/*
 	* Returns the UV coordinate at the given locatino.
 	*/UFUNCTION(BlueprintCallable, Category = "NavMesh Render")
 	FVector2D GetUV_Coordinate(const FVector& location, float centralHeight) const;
 	/*
+	* Returns the UV coordinates of many locations at once, in the same order.
+	* centralHeights must either match locations or be empty, in which case each location's Z is used.
+	*/UFUNCTION(BlueprintCallable, Category = "NavMesh Render")
+	void GetUV_Coordinates(const TArray<FVector>& locations, const TArray<float>& centralHeights, TArray<FVector2D>& outUVs) const;
+	/*
+	* Maps world XY on the given floor to the render's UVs: UV = XY * outScale + outOffset. Matches GetUV_Coordinate with or without packed floors.
+	* The render material gets the same transforms as the vector parameters FloorUVTransform0, FloorUVTransform1, ... holding (scale X, scale Y, offset X, offset Y).
+	*/UFUNCTION(BlueprintPure, Category = "NavMesh Render")
+	void GetFloorUVTransform(int32 floor, FVector2D& outScale, FVector2D& outOffset) const;
+	/*
+	* Copy of the layout UVs are calculated with. Take it on the game thread, then use FNavMeshRenderLayout::UVCoords from any thread.
+	*/
+	FNavMeshRenderLayout GetRenderLayout() const;
+	/*
+	* Finds the rendered triangle under the location along with its nav poly, barycentrics and UV.
+	* Only triangles within maxHeightDelta of the location's height count, and the closest in height wins.
+	* The first query after loading a saved render rebuilds the query data.
+	*/UFUNCTION(BlueprintCallable, Category = "NavMesh Render")
+	bool FindRenderHit(const FVector& location, FNavMeshRenderHit& outHit, float maxHeightDelta = 100.f);
+	/*
+	* FindRenderHit for many locations at once. outHits matches locations.
+	*/UFUNCTION(BlueprintCallable, Category = "NavMesh Render")
+	void FindRenderHits(const TArray<FVector>& locations, TArray<FNavMeshRenderHit>& outHits, float maxHeightDelta = 100.f);
+	/*
 	* Updates the render to fit the world's NavMesh.
 	* WARNING: If done during runtime this will cause momentary freezing
 	*/UFUNCTION(BlueprintCallable, CallInEditor, Category = "NavMesh Render")
 	void UpdateMesh();
 	/*
+	* Updates the render on a worker thread and swaps the result in on the game thread. OnMeshUpdate is called once it is applied.
+	* Overlapping requests are coalesced so only the latest one is applied. Returns false if no Navigation Mesh could be read.
+	*/UFUNCTION(BlueprintCallable, Category = "NavMesh Render")
+	bool UpdateMeshAsync();
+	/*
+	* Updates the render on the game thread across several frames, spending at most TimeSliceBudgetMs each frame. Agent renders are sliced the same way.
+	* OnMeshBuildProgress is called after every slice and OnMeshUpdate once it is applied. Restarts any time sliced update already running.
+	*/UFUNCTION(BlueprintCallable, Category = "NavMesh Render")
+	bool UpdateMeshTimeSliced();
+	/*
+	* Progress of the running time sliced update from 0 to 1. Returns 1 when none is running.
+	*/UFUNCTION(BlueprintPure, Category = "NavMesh Render")
+	float GetBuildProgress() const;
+	/*
+	* Rebuilds the render only if the nav tile data or the render settings changed since it was last built.
+	* Otherwise the saved render is kept as is. Returns true if it rebuilt.
+	*/UFUNCTION(BlueprintCallable, Category = "NavMesh Render")
+	bool UpdateMeshIfStale();
+	/*
+	* Rebuilds only the tiles that Recast replaced since the last update, leaving the rest of the mesh untouched.
+	* Falls back to a full UpdateMesh if nothing has been built yet or the nav bounds/floors changed.
+	*/UFUNCTION(BlueprintCallable, Category = "NavMesh Render")
+	bool UpdateChangedTiles();
+	/*
+	* Returns true while an asynchronous update is running.
+	*/UFUNCTION(BlueprintPure, Category = "NavMesh Render")
+	bool IsUpdatingAsync() const;
+	/*
 	* Deletes the render's tris.
 	*/UFUNCTION(BlueprintCallable, Category = "NavMesh Render", meta=(DisplayName = "Clear Mesh"))
 	void ClearMesh();
@@ -51,6 +137,69 @@ public:
 	*/UFUNCTION(CallInEditor, Category = "NavMesh Render", meta = (DisplayName = "Save Mesh"))
 	void z_SaveMesh();
 	/*
+	* Saves the currently rendered mesh as a Static Mesh Asset under the given long package name. Editor only.
+	* The asset is created in memory, saving its package to disk is up to the caller.
+	*/
+	UStaticMesh* SaveMeshAsset(const FString& packageName);
+	/*
+	* Changes whenever the nav tile data or a render setting changes. 0 when there is no nav mesh.
+	*/
+	uint32 GetNavMeshRenderHash() const;
+	/*
+	* Shows only the areas whose bit is set, bit N being area ID N. -1 shows every area.
+	* Sets AreaMask0 to AreaMask3 on the render material, 16 bits each, and never rebuilds.
+	*/UFUNCTION(BlueprintCallable, Category = "NavMesh Render")
+	void SetAreaMask(int64 areaMask);
+	UFUNCTION(BlueprintPure, Category = "NavMesh Render")
+	int64 GetAreaMask() const;
+	/*
+	* Loads and unloads chunks around the viewers now instead of waiting for StreamingUpdateInterval, e.g. after a teleport.
+	* Does nothing unless streaming.
+	*/UFUNCTION(BlueprintCallable, Category = "NavMesh Render|Streaming")
+	void UpdateStreaming();
+	/*
+	* Returns true while only the chunks around the viewers are rendered.
+	*/UFUNCTION(BlueprintPure, Category = "NavMesh Render|Streaming")
+	bool IsStreaming() const;
+	/*
+	* Rasterizes the floor atlas on the CPU, at the same UVs as the render: coverage in R, floor in G, area ID in B and height in A.
+	* Only the nav tiles that changed since the last raster are redone, everything the first time or when the layout or size changed.
+	* Needs no GPU, so it also works on servers and in commandlets. size overrides RasterSize when above 0.
+	* Returns false if no Navigation Mesh could be read.
+	*/UFUNCTION(BlueprintCallable, Category = "NavMesh Render|Raster")
+	bool UpdateRaster(int32 size = 0);
+	/*
+	* The raster as a texture. Null until rasterized, and whenever the game can't render, e.g. on dedicated servers.
+	*/UFUNCTION(BlueprintPure, Category = "NavMesh Render|Raster")
+	UTexture2D* GetRasterTexture() const;
+	/*
+	* The rasterized texels row by row, GetRasterSize wide. Empty until rasterized.
+	*/
+	TConstArrayView<FColor> GetRasterTexels() const;
+	FIntPoint GetRasterSize() const;
+	/*
+	* Sets the highlight color of each poly, e.g. a path corridor or the polys in a threat zone. Needs bPolyHighlights.
+	* Each poly is one texel of the highlight texture, and the texels changed in a frame are uploaded together at the start of the next, so the render is never rebuilt.
+	* A transparent color removes the highlight. Refs that aren't current polys of the main nav mesh are skipped. Returns how many polys were set.
+	*/UFUNCTION(BlueprintCallable, Category = "NavMesh Render|Highlights")
+	int32 SetPolyHighlights(const TArray<int64>& polyRefs, FLinearColor color);
+	/*
+	* Removes every poly highlight.
+	*/UFUNCTION(BlueprintCallable, Category = "NavMesh Render|Highlights")
+	void ClearPolyHighlights();
+	/*
+	* The highlight colors, poly index across and tile index down. Null until highlighted, and whenever the game can't render.
+	*/UFUNCTION(BlueprintPure, Category = "NavMesh Render|Highlights")
+	UTexture2D* GetHighlightTexture() const;
+	/*
+	* Shows or hides an additional agent's render without rebuilding it.
+	*/UFUNCTION(BlueprintCallable, Category = "NavMesh Render")
+	void SetAgentVisibility(FName agentName, bool bVisible);
+	/*
+	* Returns the render of an additional agent, or null if it has none.
+	*/UFUNCTION(BlueprintCallable, Category = "NavMesh Render")
+	UDynamicMeshComponent* GetAgentRender(FName agentName) const;
+	/*
 	* Where to save the mesh at. Empty will save it inside the Content folder.
 	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render|Saving", meta=(DisplayName="Save Folder: /Game/"))
 	FString SaveLocation;
@@ -60,10 +209,6 @@ public:
 	FString SaveName = FString("SM_NavMesh");
 
 private:
-	/*
-	* Assigns a new vertex along with UVs, normals, etc.
-	*/UFUNCTION()
-	int AssignNewVert(const FVector& location, float UVHeight);
 	/*
 	* Calculates a UV coordinate for the given locaiton.
 	*/UFUNCTION()
@@ -78,6 +223,128 @@ private:
 	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render")
 	int ZOffset = 0.f;
 	/*
+	* During play, rebuild the changed tiles whenever the navigation system finishes regenerating.
+	* Intended for dynamic and modifier-only navmeshes.
+	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render")
+	bool bUpdateChangedTiles = false;
+	/*
+	* How nav polys are split into triangles. ConvexFan uses the fewest triangles and verts,
+	* DetailMesh matches the ground height of Recast's detail mesh.
+	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render")
+	ENavMeshRenderTriangulation Triangulation = ENavMeshRenderTriangulation::CenterFan;
+	/*
+	* Renders through a lightweight component whose CPU copy keeps only quantized positions, UVs and 16-bit indices where they fit.
+	* That copy uses several times less memory on large navmeshes. GPU vertices match a static mesh's, only without colors.
+	* Changed tiles can't be patched into it, so they always rebuild everything.
+	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render")
+	bool bCompactRender = false;
+	/*
+	* Other agents whose nav meshes are rendered along with the main one, each into its own component.
+	* They are built in the same pass as the main render and share its floors and UV layout.
+	* Chunks, Compact Render and FindRenderHit only apply to the main nav mesh.
+	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render|Agents")
+	TArray<FNavMeshRenderAgent> Agents;
+	/*
+	* Bit N shows area ID N. Every vertex color holds its poly's area ID in R and poly flags in G (low byte) and B (high byte), each divided by 255,
+	* so materials can filter and color areas through the AreaMask0 to AreaMask3 parameters. Compact Render carries no area data.
+	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render|Areas")
+	int64 AreaMask = -1;
+	/*
+	* Milliseconds a time sliced update may spend per frame.
+	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render", meta = (ClampMin = 0.1f, UIMax = 16.f))
+	float TimeSliceBudgetMs = 2.f;
+	/*
+	* Splits the render into chunks of this many nav tiles square. Each chunk gets its own component with bounds fitting its tris,
+	* so chunks are frustum/distance culled individually and tile updates only touch the chunks they fall in.
+	* 0 renders everything in a single component.
+	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render|Chunks", meta = (ClampMin = 0))
+	int ChunkSizeInTiles = 0;
+	/*
+	* Chunks further than this from the view are culled. 0 disables distance culling.
+	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render|Chunks", meta = (ClampMin = 0.f, EditCondition = "ChunkSizeInTiles > 0"))
+	float ChunkCullDistance = 0.f;
+	/*
+	* During play, only render the chunks within StreamingRadius of a local player's view. Chunks that come within range are built on worker threads
+	* and chunks that leave it are unloaded, so memory and build time depend on the radius instead of the size of the world.
+	* Streams single tiles when ChunkSizeInTiles is 0. Compact Render is not used while streaming and additional agents are always rendered in full.
+	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render|Streaming")
+	bool bStreamAroundViewers = false;
+	/*
+	* Chunks closer than this to a viewer in XY are loaded.
+	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render|Streaming", meta = (ClampMin = 0.f, EditCondition = "bStreamAroundViewers"))
+	float StreamingRadius = 20000.f;
+	/*
+	* How much further than StreamingRadius a chunk has to be before it is unloaded, so chunks on the edge don't keep reloading.
+	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render|Streaming", meta = (ClampMin = 0.f, EditCondition = "bStreamAroundViewers"))
+	float StreamingUnloadMargin = 2000.f;
+	/*
+	* Seconds between checks of the viewers' locations.
+	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render|Streaming", meta = (ClampMin = 0.f, EditCondition = "bStreamAroundViewers"))
+	float StreamingUpdateInterval = 0.25f;
+	/*
+	* Most chunks building on worker threads at once. Each one is gathered on the game thread before it is launched.
+	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render|Streaming", meta = (ClampMin = 1, EditCondition = "bStreamAroundViewers"))
+	int StreamingMaxBuilds = 4;
+	/*
+	* Unloaded chunk components kept for reuse by the next chunks that load. Any beyond this are destroyed.
+	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render|Streaming", meta = (ClampMin = 0, EditCondition = "bStreamAroundViewers"))
+	int StreamingPoolSize = 16;
+	/*
+	* During play, patch in the nav tiles that streamed levels and World Partition cells attach, and take out the ones they detach,
+	* leaving the rest of the render untouched. A render that was loaded rather than built is rebuilt asynchronously the first time.
+	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render|Streaming")
+	bool bFollowNavStreaming = true;
+	/*
+	* Triangulated tiles kept after they stream out, so streaming them back in skips gathering and triangulating them. 0 disables the cache.
+	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render|Streaming", meta = (ClampMin = 0))
+	int TileCacheSize = 256;
+	/*
+	* Draws the nav mesh's edges as lines, built along with the render. Far cheaper to draw than the filled render over a whole level.
+	* Only the main nav mesh is outlined.
+	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render|Outline")
+	bool bRenderOutline = false;
+	/*
+	* Also outline the edges between nav tiles, not only the borders of the nav mesh.
+	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render|Outline", meta = (EditCondition = "bRenderOutline"))
+	bool bOutlineTileEdges = false;
+	/*
+	* Also draw off-mesh links as a line from their start to their end.
+	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render|Outline", meta = (EditCondition = "bRenderOutline"))
+	bool bOutlineOffMeshLinks = true;
+	UPROPERTY(EditAnywhere, Category = "NavMesh Render|Outline", meta = (EditCondition = "bRenderOutline"))
+	FLinearColor OutlineColor = FLinearColor(1.f, 0.6f, 0.f);
+	UPROPERTY(EditAnywhere, Category = "NavMesh Render|Outline", meta = (EditCondition = "bRenderOutline && bOutlineTileEdges"))
+	FLinearColor OutlineTileEdgeColor = FLinearColor(0.1f, 0.4f, 1.f);
+	UPROPERTY(EditAnywhere, Category = "NavMesh Render|Outline", meta = (EditCondition = "bRenderOutline && bOutlineOffMeshLinks"))
+	FLinearColor OutlineOffMeshLinkColor = FLinearColor(1.f, 0.1f, 0.8f);
+	/*
+	* Line thickness in world units. 0 draws single pixel lines.
+	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render|Outline", meta = (ClampMin = 0.f, EditCondition = "bRenderOutline"))
+	float OutlineThickness = 2.f;
+	/*
+	* The outline is culled further than this from the view. 0 disables distance culling.
+	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render|Outline", meta = (ClampMin = 0.f, EditCondition = "bRenderOutline"))
+	float OutlineCullDistance = 0.f;
+	/*
+	* Keeps a CPU rasterized copy of the floor atlas in step with every build and tile change, see UpdateRaster.
+	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render|Raster")
+	bool bRasterizeAtlas = false;
+	/*
+	* Width and height of the raster in texels.
+	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render|Raster", meta = (ClampMin = 1, UIMax = 4096))
+	int RasterSize = 1024;
+	/*
+	* Copies the raster into a texture, see GetRasterTexture. Only the parts that were rasterized again are uploaded.
+	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render|Raster")
+	bool bRasterTexture = true;
+	/*
+	* Gives the render a second UV layer with each poly's texel of the highlight texture, so polys can be highlighted without rebuilding, see SetPolyHighlights.
+	* Tiles follow each other through the texture row by row, see FNavMeshRenderLayout::GetHighlightTexel. Tiles past the platform's largest texture can't be highlighted.
+	* The material gets the texture as HighlightTexture and its size as HighlightTextureSize, and samples it at (UV1 + 0.5) / HighlightTextureSize.
+	* Changing this rebuilds the render. Compact Render and agents aren't highlighted.
+	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render|Highlights")
+	bool bPolyHighlights = false;
+	/*
 	* Debug value that shows the number of floors.
 	*/UPROPERTY(VisibleAnywhere, Category = "NavMesh Render")
 	int NumberOfFloors = -1;
@@ -110,6 +377,20 @@ private:
 	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render|UVs", meta = (UIMin = 0.f, UIMax = 1.f, ClampMin = 0.f, ClampMax = 1.f))
 	float UV_IslandMargins = 0.f;
 	/*
+	* Packs each floor's actual XY footprint into the UVs instead of giving every floor a full square of the floor grid.
+	* All floors keep the same texel density and the UVs are filled far more tightly, so a smaller render target shows the same detail.
+	* Footprints are measured from the nav tile bounds on every build. When one changes, every UV moves and the whole render is rebuilt.
+	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render|UVs")
+	bool bPackFloorUVs = false;
+	/*
+	* UV transform of each floor while packed, see FNavMeshRenderLayout::FloorUVTransforms. Saved so a loaded render keeps its UVs.
+	*/UPROPERTY()
+	TArray<FVector4> FloorUVTransforms;
+	/*
+	* Measures each floor's footprint from the nav tile bounds and packs the floors into the layout's FloorUVTransforms.
+	*/
+	void PackFloorUVs(const ARecastNavMesh& navMesh, FNavMeshRenderLayout& layout) const;
+	/*
 	* Material to be used on the renderer.
 	*/UPROPERTY(EditAnywhere, Category = "NavMesh Render", meta = (DisplayThumbnail = "false"))
 	TObjectPtr<UMaterialInterface> NavMeshMaterial;
@@ -118,6 +399,87 @@ private:
 	*/UPROPERTY()
 	TObjectPtr<UDynamicNavMeshRendererComponent> DynamicNavMeshRender;
 	/*
+	* The chunk components, keyed by chunk coordinate. Only used when ChunkSizeInTiles is set.
+	*/UPROPERTY()
+	TMap<FIntPoint, TObjectPtr<UDynamicNavMeshRendererComponent>> ChunkComponents;
+	/*
+	* The compact components, keyed by chunk coordinate. Only used when bCompactRender is set.
+	* Without chunks everything goes into 0,0.
+	*/UPROPERTY()
+	TMap<FIntPoint, TObjectPtr<UNavMeshCompactRenderComponent>> CompactComponents;
+	/*
+	* The render of each additional agent, keyed by agent name.
+	*/UPROPERTY()
+	TMap<FName, TObjectPtr<UDynamicNavMeshRendererComponent>> AgentComponents;
+	/*
+	* The chunk size the current render was built with.
+	*/
+	int BuiltChunkSizeInTiles = 0;
+	/*
+	* Hash of the nav tile data the saved render was built from. 0 when nothing has been built.
+	*/UPROPERTY()
+	uint32 BuiltNavDataHash = 0;
+	/*
+	* Hash of the agents' nav tile data the saved agent renders were built from. 0 when there are none.
+	*/UPROPERTY()
+	uint32 BuiltAgentsNavDataHash = 0;
+	/*
+	* Hash of the render settings the saved render was built with.
+	*/UPROPERTY()
+	uint32 BuiltSettingsHash = 0;
+	/*
+	* Set once UpdateMeshIfStale could reach the nav mesh. Loading may happen before navigation is ready.
+	*/
+	bool bRenderCacheChecked = false;
+	/*
+	* Hash of every setting that changes the built render, plus the nav bounds.
+	*/
+	uint32 GetSettingsHash(const ARecastNavMesh& navMesh) const;
+	/*
+	* Combines the data hashes of every built tile.
+	*/
+	uint32 GetBuiltNavDataHash() const;
+	/*
+	* Combines the nav data hashes of every agent's render.
+	*/
+	uint32 GetBuiltAgentsNavDataHash() const;
+	/*
+	* Combines the current nav data hashes of every additional agent. Matches GetBuiltAgentsNavDataHash once they are built.
+	*/
+	uint32 GetAgentsNavDataHash() const;
+	/*
+	* Nav meshes of the additional agents, skipping agents without one and the main nav mesh.
+	*/
+	TArray<TPair<FName, const ARecastNavMesh*>> GetAgentNavMeshes() const;
+	/*
+	* Copies out the tiles of every additional agent for building.
+	*/
+	void SnapshotAgents(ENavMeshRenderTriangulation triangulation, TArray<FNavMeshRenderAgentBuild>& outAgentBuilds) const;
+	/*
+	* Swaps built agent meshes into their components and removes agents that are no longer built.
+	*/
+	void ApplyBuiltAgents(TArray<FNavMeshRenderAgentBuild>&& agentBuilds);
+	/*
+	* Rebuilds only the additional agents, e.g. after one of their nav meshes regenerated.
+	*/
+	void UpdateAgentMeshes();
+	/*
+	* Returns the component of the given agent, creating it if needed.
+	*/
+	UDynamicNavMeshRendererComponent* FindOrAddAgentComponent(FName agentName);
+	/*
+	* Destroys every agent component whose agent is not in keepAgents.
+	*/
+	void DestroyAgentComponents(const TSet<FName>& keepAgents);
+	/*
+	* Applies the agent's material and visibility to its component.
+	*/
+	void RefreshAgentComponent(UDynamicNavMeshRendererComponent* agentComponent, const FNavMeshRenderAgent& agent);
+	/*
+	* Reapplies every agent's material and visibility.
+	*/
+	void RefreshAgentComponents();
+	/*
 	* The negative corner of the nav mesh. This is used for UVs.
 	*/UPROPERTY()
 	FVector NavMeshCorner;
@@ -130,6 +492,284 @@ private:
 	*/UPROPERTY()
 	int FloorRowSize = 1;
 	/*
+	* Highlight texels of each tile slot in the built render, see FNavMeshRenderLayout::HighlightTileStride. Saved so a loaded render keeps its highlights.
+	*/UPROPERTY()
+	int32 HighlightTileStride = 0;
+	/*
+	* Reads the world's nav mesh and works out the layout a build of it would use. Nothing the current render is shown or queried with changes,
+	* that only happens once the build is applied, see CommitRenderLayout.
+	*/
+	const ARecastNavMesh* PrepareBuild(FNavMeshRenderLayout& outLayout);
+	/*
+	* The layout of the current settings over the given nav mesh: its bounds, floors and packed floor UVs.
+	*/
+	FNavMeshRenderLayout MakeRenderLayout(const ARecastNavMesh& navMesh) const;
+	/*
+	* Makes a built layout the one the render is shown and queried with: RenderLayout, the saved sizes and floors, the bounds and the material.
+	*/
+	void CommitRenderLayout(const FNavMeshRenderLayout& layout);
+	/*
+	* PrepareBuild, then copies out the tile data for building.
+	*/
+	bool SnapshotNavMesh(TArray<FNavMeshRenderTileSnapshot>& outTiles, uint32& outSettingsHash, FNavMeshRenderLayout& outLayout);
+	/*
+	* Swaps finished chunk meshes into their render components, commits the layout they were built with and removes chunks that are no longer used.
+	*/
+	void ApplyBuiltChunks(const FNavMeshRenderLayout& layout, TArray<FNavMeshRenderChunk>&& builtChunks, TArray<FNavMeshRenderAgentBuild>&& agentBuilds, int chunkSizeInTiles, uint32 settingsHash);
+	/*
+	* Returns the main component followed by every chunk component.
+	*/
+	TArray<UDynamicNavMeshRendererComponent*> GetRenderComponents() const;
+	/*
+	* Returns the component of the given chunk, creating it if needed.
+	*/
+	UDynamicNavMeshRendererComponent* FindOrAddChunkComponent(const FIntPoint& chunkCoord);
+	/*
+	* Destroys every chunk component whose coordinate is not in keepChunks.
+	*/
+	void DestroyChunkComponents(const TSet<FIntPoint>& keepChunks);
+	/*
+	* Empties the chunk's component and moves it into ChunkComponentPool, or destroys it if the pool is full.
+	*/
+	void ReleaseChunkComponent(const FIntPoint& chunkCoord);
+	/*
+	* Destroys every pooled chunk component.
+	*/
+	void EmptyChunkComponentPool();
+	/*
+	* Unloaded chunk components, still registered but hidden and empty. FindOrAddChunkComponent takes from here before creating one.
+	*/UPROPERTY(Transient)
+	TArray<TObjectPtr<UDynamicNavMeshRendererComponent>> ChunkComponentPool;
+	/*
+	* Applies the material and culling settings and pushes a component's mesh to the renderer.
+	*/
+	void RefreshRenderComponent(UDynamicNavMeshRendererComponent* renderComponent);
+	/*
+	* Returns the compact component of the given chunk, creating it if needed.
+	*/
+	UNavMeshCompactRenderComponent* FindOrAddCompactComponent(const FIntPoint& chunkCoord);
+	/*
+	* Destroys every compact component whose coordinate is not in keepChunks.
+	*/
+	void DestroyCompactComponents(const TSet<FIntPoint>& keepChunks);
+	/*
+	* Applies the material and culling settings to a compact component.
+	*/
+	void RefreshCompactComponent(UNavMeshCompactRenderComponent* compactComponent);
+	/*
+	* Recounts the debug vert and tri totals across all components.
+	*/
+	void UpdateRenderStats();
+	/*
+	* Recounts the memory held by the render and reports it to "stat NavMeshRender".
+	*/
+	void UpdateMemoryStats();
+	/*
+	* Replaces this renderer's share of the memory stats.
+	*/
+	void SetMemoryStats(SIZE_T dynamicMeshBytes, SIZE_T compactMeshBytes, SIZE_T spatialIndexBytes, SIZE_T tileCacheBytes, SIZE_T rasterBytes);
+	SIZE_T ReportedDynamicMeshBytes = 0;
+	SIZE_T ReportedCompactMeshBytes = 0;
+	SIZE_T ReportedSpatialIndexBytes = 0;
+	SIZE_T ReportedTileCacheBytes = 0;
+	SIZE_T ReportedRasterBytes = 0;
+	/*
+	* Appends every rendered component's mesh into one.
+	*/
+	void CopyRenderedMesh(UE::Geometry::FDynamicMesh3& outMesh) const;
+	/*
+	* Snapshots the nav mesh and starts building it on a worker thread.
+	*/
+	bool LaunchAsyncBuild();
+	/*
+	* Game thread continuation of LaunchAsyncBuild.
+	*/
+	void FinishAsyncBuild(uint32 buildSerial, const FNavMeshRenderLayout& layout, TArray<FNavMeshRenderChunk>&& builtChunks, TArray<FNavMeshRenderAgentBuild>&& agentBuilds, int chunkSizeInTiles, uint32 settingsHash);
+	/*
+	* Runs the next slice of the time sliced update and applies it once finished.
+	*/
+	void ContinueTimeSlicedBuild();
+	/*
+	* Stops the time sliced update without applying it.
+	*/
+	void CancelTimeSlicedBuild();
+	/*
+	* The running time sliced update, if any.
+	*/
+	TSharedPtr<FNavMeshRenderTimeSlicedBuild> TimeSlicedBuild;
+	uint32 TimeSlicedBuildSerial = 0;
+	uint32 TimeSlicedSettingsHash = 0;
+	int TimeSlicedChunkSizeInTiles = 0;
+	/*
+	* Layout the running time sliced update builds with. It becomes RenderLayout once applied.
+	*/
+	FNavMeshRenderLayout TimeSlicedLayout;
+	/*
+	* Point query data over the rendered triangles. Kept in step with the render by every build.
+	*/
+	TSharedPtr<FNavMeshRenderSpatialIndex> SpatialIndex;
+	/*
+	* Replaces the query data with the tiles of freshly built chunks.
+	*/
+	void ApplyBuiltSpatialIndex(TArray<FNavMeshRenderChunk>& builtChunks);
+	/*
+	* Returns complete query data, rebuilding it from the nav mesh if the render was loaded rather than built.
+	*/
+	const FNavMeshRenderSpatialIndex* EnsureSpatialIndex();
+	/*
+	* Which chunks are loaded or building while streaming. Null when not streaming.
+	*/
+	TSharedPtr<FNavMeshRenderStreaming> Streaming;
+	/*
+	* Incremented by every streamed chunk build.
+	*/
+	uint32 StreamingBuildSerial = 0;
+	float StreamingTimeSinceUpdate = 0.f;
+	/*
+	* True when bStreamAroundViewers is set in a game world.
+	*/
+	bool ShouldStream() const;
+	/*
+	* Drops the current render and starts streaming from scratch.
+	*/
+	void RestartStreaming();
+	/*
+	* Reads the nav mesh, replaces the render with an empty one and maps the tiles to chunks. Returns false if no Navigation Mesh could be read.
+	*/
+	bool PrepareStreaming();
+	/*
+	* Rechecks the loaded chunks after the nav mesh changed, rebuilding those whose tiles were replaced.
+	*/
+	void RefreshStreamingTiles();
+	/*
+	* View locations of every local player. These follow the view target.
+	*/
+	void GetStreamingViewers(TArray<FVector>& outViewers) const;
+	/*
+	* Gathers the chunk's tiles and builds them on a worker thread.
+	*/
+	void LaunchStreamingChunkBuild(const ARecastNavMesh& navMesh, const FIntPoint& chunkCoord);
+	/*
+	* Game thread continuation of LaunchStreamingChunkBuild.
+	*/
+	void FinishStreamingChunkBuild(uint32 buildSerial, const FIntPoint& chunkCoord, TArray<FNavMeshRenderChunk>&& builtChunks);
+	/*
+	* Removes a chunk's render and query data.
+	*/
+	void UnloadStreamingChunk(const FIntPoint& chunkCoord);
+	/*
+	* Ticks while a time sliced update is running or while streaming.
+	*/
+	void UpdateTickEnabled();
+	/*
+	* Draws the outline. Lines aren't saved, so it is gathered again from the nav mesh whenever the render is built or reused.
+	*/UPROPERTY(Transient)
+	TObjectPtr<ULineBatchComponent> OutlineComponent;
+	/*
+	* Outline edges of every drawn tile. Null while bRenderOutline is off.
+	*/
+	TSharedPtr<FNavMeshRenderOutline> Outline;
+	/*
+	* Gathers the outline again if the edges it should contain changed, otherwise only redraws it with the current style.
+	*/
+	void RefreshOutline();
+	/*
+	* Gathers the outline of every drawn tile and draws it.
+	*/
+	void RebuildOutline();
+	/*
+	* Gathers the outline of the given tiles and their neighbors again, e.g. after they changed or streamed in or out.
+	*/
+	void UpdateOutlineTiles(const TArray<int32>& tileIndices);
+	/*
+	* Replaces the outline component's lines with the current outline.
+	*/
+	void DrawOutline();
+	void DestroyOutline();
+	/*
+	* True if the tile is part of the render. Only streaming leaves tiles out.
+	*/
+	bool IsTileRendered(const ARecastNavMesh& navMesh, int32 tileIndex) const;
+	/*
+	* The CPU rasterized floor atlas. Null until UpdateRaster runs.
+	*/
+	TSharedPtr<FNavMeshRenderRaster> Raster;
+	UPROPERTY(Transient)
+	TObjectPtr<UTexture2D> RasterTexture;
+	/*
+	* Copies the given texel rects of the raster into RasterTexture, or all of it when the texture is new or bFullUpload is set.
+	*/
+	void UploadRaster(const TArray<FIntRect>& updatedRects, bool bFullUpload);
+	/*
+	* Copies texel rects into a transient data texture. A texture that is missing or of another size is made again with every texel.
+	* Returns true if the texture was made again.
+	*/
+	static bool UploadTexels(TObjectPtr<UTexture2D>& texture, TConstArrayView<FColor> texels, const FIntPoint& size, const TArray<FIntRect>& updatedRects, bool bFullUpload);
+	/*
+	* The poly highlight colors. Null until highlights are used.
+	*/
+	TSharedPtr<FNavMeshRenderHighlights> Highlights;
+	UPROPERTY(Transient)
+	TObjectPtr<UTexture2D> HighlightTexture;
+	/*
+	* Fits the highlights to the nav mesh after a build or tile change and drops those of replaced tiles.
+	*/
+	void RefreshHighlights();
+	/*
+	* Uploads the changed highlights on the next tick, once however often they change until then.
+	*/
+	void RequestHighlightUpload();
+	void UploadHighlights();
+	bool bHighlightUploadPending = false;
+	/*
+	* Tiles rebuilt by UpdateChangedTiles, kept for when they stream back in.
+	*/
+	TSharedPtr<FNavMeshRenderTileCache> TileCache;
+	/*
+	* Bound to level streaming while bFollowNavStreaming is set. Navigation attaches a level's nav data in its own handler, so the tiles are compared a tick later.
+	*/
+	void OnLevelStreamingChanged(ULevel* level, UWorld* world);
+	/*
+	* Patches the tiles that were attached or detached since the last update into the render.
+	*/
+	void UpdateStreamedNavTiles();
+	FDelegateHandle LevelAddedHandle;
+	FDelegateHandle LevelRemovedHandle;
+	bool bNavStreamingUpdatePending = false;
+	/*
+	* Bound to the navigation system while bUpdateChangedTiles is set.
+	*/UFUNCTION()
+	void OnNavigationGenerationFinished(ANavigationData* navData);
+	/*
+	* Incremented by every build. Async results that don't match are discarded.
+	*/
+	uint32 LatestBuildSerial = 0;
+	bool bAsyncBuildInFlight = false;
+	/*
+	* Set when an async update is requested while one is already running.
+	*/
+	bool bAsyncBuildPending = false;
+	/*
+	* Layout of the applied render, used by UV queries, the material and tile patches.
+	*/
+	FNavMeshRenderLayout RenderLayout;
+	/*
+	* Copies the current settings into RenderLayout, e.g. after loading.
+	*/UFUNCTION()
+	void RefreshRenderLayout();
+	/*
+	* Instance of NavMeshMaterial the area mask, packed floor UVs and highlight texture are set on. Only made once one of them is used.
+	*/UPROPERTY(Transient)
+	TObjectPtr<UMaterialInstanceDynamic> ParameterMaterial;
+	/*
+	* The parameter instance if there is one, otherwise NavMeshMaterial.
+	*/
+	UMaterialInterface* GetRenderMaterial() const;
+	/*
+	* Pushes AreaMask, the floor UV transforms and the highlight texture to the material and makes sure every component renders with it.
+	*/
+	void ApplyMaterialParameters();
+	/*
 	* Called after the mesh has been updated.
 	*/UFUNCTION()
 	void FinishedProcessing();